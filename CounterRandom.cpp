@@ -0,0 +1,55 @@
+#include "CounterRandom.h"
+#include <cmath>
+
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9; // golden ratio
+static const uint32_t PHILOX_W1 = 0xBB67AE85; // sqrt(3) - 1
+static const int PHILOX_ROUNDS = 10;
+static const double TWO_PI = 6.283185307179586476925286766559;
+static const double TWO_POW_MINUS_53 = 1.0 / 9007199254740992.0;
+
+Philox4x32::Philox4x32(uint64_t seed)
+{
+    key[0] = static_cast<uint32_t>(seed);
+    key[1] = static_cast<uint32_t>(seed >> 32);
+}
+
+void Philox4x32::generate(const uint32_t counter[4], uint32_t out[4]) const
+{
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+        uint64_t product1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+        uint32_t hi0 = static_cast<uint32_t>(product0 >> 32), lo0 = static_cast<uint32_t>(product0);
+        uint32_t hi1 = static_cast<uint32_t>(product1 >> 32), lo1 = static_cast<uint32_t>(product1);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+void Philox4x32::normalPair(const uint32_t counter[4], double &first, double &second) const
+{
+    uint32_t bits[4];
+    generate(counter, bits);
+
+    // 53 random bits each: u1 in (0, 1] keeps the log finite, u2 in [0, 1)
+    uint64_t high = (static_cast<uint64_t>(bits[0]) << 21) | (bits[1] >> 11);
+    uint64_t low = (static_cast<uint64_t>(bits[2]) << 21) | (bits[3] >> 11);
+    double u1 = (high + 1) * TWO_POW_MINUS_53;
+    double u2 = low * TWO_POW_MINUS_53;
+
+    double radius = sqrt(-2.0 * log(u1));
+    double angle = TWO_PI * u2;
+    first = radius * cos(angle);
+    second = radius * sin(angle);
+}
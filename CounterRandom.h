@@ -0,0 +1,26 @@
+#ifndef COUNTER_RANDOM_H
+#define COUNTER_RANDOM_H
+
+#include <cstdint>
+
+using namespace std;
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy
+// as 1, 2, 3"). Output is a pure function of (key, counter), so any draw of any stream can
+// be computed directly, in any order and on any thread, without carrying generator state.
+class Philox4x32
+{
+private:
+    uint32_t key[2];
+
+public:
+    explicit Philox4x32(uint64_t seed);
+
+    // Encrypts the 128-bit counter into four independent uniformly distributed words
+    void generate(const uint32_t counter[4], uint32_t out[4]) const;
+
+    // Two independent standard normal draws for the given counter (Box-Muller)
+    void normalPair(const uint32_t counter[4], double &first, double &second) const;
+};
+
+#endif // COUNTER_RANDOM_H
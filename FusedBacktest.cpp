@@ -0,0 +1,137 @@
+#include "FusedBacktest.h"
+#include "StrategyKernels.h"
+#include <algorithm>
+
+FusedBacktest::FusedBacktest(IndicatorEngine &indicators, int startDay, int endDay)
+: indicators(indicators), prices(indicators.getPrices()), startDay(startDay), endDay(endDay){
+}
+
+void FusedBacktest::addStrategy(const Strategy *strategy)
+{
+    int slot = static_cast<int>(actions.size());
+    actions.push_back(HOLD);
+
+    SignalRule rule;
+    bool inRange = startDay >= indicators.getFirstIndex() && endDay <= indicators.getEndIndex();
+    if (inRange && strategy->describeRule(indicators, rule)) {
+        if (rule.kind == SignalRule::CROSSOVER) {
+            crossoverSlots.push_back(slot);
+            crossoverFast.push_back(rule.fast);
+            crossoverSlow.push_back(rule.slow);
+            return;
+        }
+        if (rule.kind == SignalRule::BAND) {
+            bandSlots.push_back(slot);
+            bandAverage.push_back(rule.average);
+            bandLower.push_back(rule.lowerFactor);
+            bandUpper.push_back(rule.upperFactor);
+            return;
+        }
+    }
+    genericSlots.push_back(slot);
+    genericStrategies.push_back(strategy);
+}
+
+int FusedBacktest::getStrategyCount() const
+{
+    return static_cast<int>(actions.size());
+}
+
+int FusedBacktest::getFallbackCount() const
+{
+    return static_cast<int>(genericSlots.size());
+}
+
+// Decides through the same kernels as the per-strategy path, so every decision matches it exactly
+void FusedBacktest::decideDay(int day)
+{
+    const double *dayPrices = prices.data();
+    int firstIndex = indicators.getFirstIndex();
+
+    for (size_t k = 0; k < crossoverSlots.size(); k++) {
+        int slot = crossoverSlots[k];
+        actions[slot] = TrendFollowingKernel(crossoverFast[k], crossoverSlow[k], firstIndex).decideDay(dayPrices, day, holding[slot]);
+    }
+
+    for (size_t k = 0; k < bandSlots.size(); k++) {
+        int slot = bandSlots[k];
+        actions[slot] = MeanReversionKernel(bandAverage[k], firstIndex, bandLower[k], bandUpper[k]).decideDay(dayPrices, day, holding[slot]);
+    }
+
+    int days = endDay - startDay;
+    for (size_t k = 0; k < genericSlots.size(); k++) {
+        actions[genericSlots[k]] = static_cast<signed char>(genericActions[k * days + (day - startDay)]);
+    }
+}
+
+// Same bookkeeping as PositionTracker, written without branches on the
+// per-strategy state so the loop over strategies can be vectorized
+void FusedBacktest::applyDay(int day)
+{
+    double price = prices[day];
+    int count = static_cast<int>(actions.size());
+    for (int slot = 0; slot < count; slot++) {
+        bool buy = actions[slot] == BUY && holding[slot] == 0.0;
+        bool sell = actions[slot] == SELL && holding[slot] == 1.0;
+        double tradeProfit = price - buyPrice[slot];
+
+        profit[slot] += sell ? tradeProfit : 0.0;
+        tradeCount[slot] += sell ? 1 : 0;
+        winningTrades[slot] += sell && tradeProfit > 0.0 ? 1 : 0;
+        buyPrice[slot] = buy ? price : buyPrice[slot];
+        holding[slot] = buy ? 1.0 : (sell ? 0.0 : holding[slot]);
+
+        bool held = holding[slot] == 1.0;
+        double equity = held ? profit[slot] + (price - buyPrice[slot]) : profit[slot];
+        exposureDays[slot] += held ? 1 : 0;
+        peakEquity[slot] = max(peakEquity[slot], equity);
+        maxDrawdown[slot] = max(maxDrawdown[slot], peakEquity[slot] - equity);
+    }
+}
+
+void FusedBacktest::run(vector<StrategyStats> &results)
+{
+    int count = static_cast<int>(actions.size());
+    results.assign(count, StrategyStats());
+    if (count == 0 || endDay <= startDay) {
+        return;
+    }
+
+    holding.assign(count, 0.0);
+    buyPrice.assign(count, 0.0);
+    profit.assign(count, 0.0);
+    peakEquity.assign(count, 0.0);
+    maxDrawdown.assign(count, 0.0);
+    tradeCount.assign(count, 0);
+    winningTrades.assign(count, 0);
+    exposureDays.assign(count, 0);
+
+    // Each fallback strategy's position only follows its own decisions, so they can all be
+    // made before the day loop, one virtual call per strategy
+    int days = endDay - startDay;
+    genericActions.resize(genericSlots.size() * days);
+    for (size_t k = 0; k < genericSlots.size(); k++) {
+        genericStrategies[k]->decideActions(indicators, startDay, endDay, genericActions.data() + k * days);
+    }
+
+    for (int day = startDay; day < endDay; day++) {
+        decideDay(day);
+        applyDay(day);
+    }
+
+    double lastPrice = prices[endDay - 1];
+    for (int slot = 0; slot < count; slot++) {
+        StrategyStats &stats = results[slot];
+        stats.profit = profit[slot];
+        stats.tradeCount = tradeCount[slot];
+        stats.winningTrades = winningTrades[slot];
+        stats.maxDrawdown = maxDrawdown[slot];
+        stats.exposureDays = exposureDays[slot];
+        if (holding[slot] == 1.0) {
+            double tradeProfit = lastPrice - buyPrice[slot];
+            stats.profit += tradeProfit;
+            stats.tradeCount++;
+            stats.winningTrades += tradeProfit > 0.0 ? 1 : 0;
+        }
+    }
+}
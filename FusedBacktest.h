@@ -0,0 +1,64 @@
+#ifndef FUSED_BACKTEST_H
+#define FUSED_BACKTEST_H
+
+#include <vector>
+#include "IndicatorEngine.h"
+#include "Leaderboard.h"
+#include "Strategy.h"
+
+using namespace std;
+
+// Backtests a batch of strategies in a single pass over the days. Strategies that can
+// describe themselves as a SignalRule are decided from the engine's shared tables; the
+// rest are decided up front with one decideActions call each. Position and P&L state is kept one
+// array per field (struct of arrays), so the daily update is a straight loop over the
+// strategies. Produces exactly the stats Strategy::backtest does.
+class FusedBacktest
+{
+private:
+    IndicatorEngine &indicators;
+    PriceView prices;
+    int startDay;
+    int endDay;
+
+    // Rule parameters, one entry per strategy of that kind; *Slots map to state rows
+    vector<int> crossoverSlots;
+    vector<const double *> crossoverFast;
+    vector<const double *> crossoverSlow;
+    vector<int> bandSlots;
+    vector<const double *> bandAverage;
+    vector<double> bandLower;
+    vector<double> bandUpper;
+    vector<int> genericSlots;
+    vector<const Strategy *> genericStrategies;
+    vector<Action> genericActions; // [generic][day - startDay], filled by run()
+
+    // Per-strategy state, indexed by slot (the order strategies were added in)
+    vector<signed char> actions;
+    vector<double> holding;
+    vector<double> buyPrice;
+    vector<double> profit;
+    vector<double> peakEquity;
+    vector<double> maxDrawdown;
+    vector<int> tradeCount;
+    vector<int> winningTrades;
+    vector<int> exposureDays;
+
+    void decideDay(int day);
+    void applyDay(int day);
+
+public:
+    // Evaluates days [startDay, endDay), which must lie within the engine's range
+    FusedBacktest(IndicatorEngine &indicators, int startDay, int endDay);
+
+    // Adds a strategy in the next slot; the engine should already hold its indicators
+    void addStrategy(const Strategy *strategy);
+    int getStrategyCount() const;
+    // Strategies decided through decideActions because they provided no rule
+    int getFallbackCount() const;
+
+    // Runs the backtest; results[slot] receives each strategy's stats
+    void run(vector<StrategyStats> &results);
+};
+
+#endif // FUSED_BACKTEST_H
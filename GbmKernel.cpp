@@ -0,0 +1,221 @@
+#include "GbmKernel.h"
+#include "Utils.h"
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GBM_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+// roundToDecimals(value, 3) computes pow(10, 3) on every call; it is exactly this factor
+static const double PRICE_SCALE = 1000.0;
+
+// exp(x) = 2^n * exp(r) with n = round(x / ln 2) and |r| <= ln 2 / 2. ln 2 is split in two
+// so n * LN2_HIGH is exact; the degree-13 Taylor polynomial is accurate to a few ulp there.
+static const double EXP_MAX_ARGUMENT = 709.0;
+static const double EXP_MIN_ARGUMENT = -708.0;
+static const double LOG2_E = 1.4426950408889634074;
+static const double LN2_HIGH = 0.693145751953125;
+static const double LN2_LOW = 1.42860682030941723212e-6;
+static const int EXP_POLYNOMIAL_DEGREE = 13;
+static const double EXP_COEFFICIENTS[EXP_POLYNOMIAL_DEGREE + 1] = {
+    1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+    1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800.0
+};
+static const long long EXPONENT_BIAS = 1023;
+
+static double roundPrice(double price)
+{
+    return round(price * PRICE_SCALE) / PRICE_SCALE;
+}
+
+// Today's Market::simulate chain: each rounded price feeds the next day
+static void simulateExact(double initialPrice, double drift, double diffusion, const double *normals, int numDays, double *prices)
+{
+    prices[0] = roundToDecimals(initialPrice, 3);
+    for (int i = 1; i < numDays; i++) {
+        double Z = normals[i - 1];
+        prices[i] = roundToDecimals(prices[i - 1] * exp(drift + diffusion * Z), 3);
+    }
+}
+
+// Log-space path for days [first, numDays), continuing from logSum accumulated before first
+static void simulateLogSpaceScalar(double start, double drift, double diffusion, const double *normals,
+                                   int first, int numDays, double logSum, double *prices)
+{
+    for (int i = first; i < numDays; i++) {
+        logSum += drift + diffusion * normals[i - 1];
+        prices[i] = roundPrice(start * exp(logSum));
+    }
+}
+
+#ifdef GBM_KERNEL_X86
+
+__attribute__((target("avx2")))
+static __m256d expAvx2(__m256d x)
+{
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN_ARGUMENT)), _mm256_set1_pd(EXP_MAX_ARGUMENT));
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2_E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(LN2_HIGH)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(LN2_LOW)));
+
+    __m256d polynomial = _mm256_set1_pd(EXP_COEFFICIENTS[EXP_POLYNOMIAL_DEGREE]);
+    for (int k = EXP_POLYNOMIAL_DEGREE - 1; k >= 0; k--) {
+        polynomial = _mm256_add_pd(_mm256_mul_pd(polynomial, r), _mm256_set1_pd(EXP_COEFFICIENTS[k]));
+    }
+
+    // 2^n assembled directly in the exponent field
+    __m256i exponent = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+    exponent = _mm256_slli_epi64(_mm256_add_epi64(exponent, _mm256_set1_epi64x(EXPONENT_BIAS)), 52);
+    return _mm256_mul_pd(polynomial, _mm256_castsi256_pd(exponent));
+}
+
+// Same result as roundPrice in every lane: std::round rounds halfway cases away from zero
+__attribute__((target("avx2")))
+static __m256d roundPriceAvx2(__m256d price)
+{
+    __m256d scaled = _mm256_mul_pd(price, _mm256_set1_pd(PRICE_SCALE));
+    __m256d truncated = _mm256_round_pd(scaled, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256d fraction = _mm256_sub_pd(scaled, truncated);
+    __m256d one = _mm256_set1_pd(1.0);
+    truncated = _mm256_add_pd(truncated, _mm256_and_pd(_mm256_cmp_pd(fraction, _mm256_set1_pd(0.5), _CMP_GE_OQ), one));
+    truncated = _mm256_sub_pd(truncated, _mm256_and_pd(_mm256_cmp_pd(fraction, _mm256_set1_pd(-0.5), _CMP_LE_OQ), one));
+    return _mm256_div_pd(truncated, _mm256_set1_pd(PRICE_SCALE));
+}
+
+__attribute__((target("avx2")))
+static void simulateLogSpaceAvx2(double initialPrice, double drift, double diffusion, const double *normals, int numDays, double *prices)
+{
+    double start = roundPrice(initialPrice);
+    prices[0] = start;
+
+    __m256d zero = _mm256_setzero_pd();
+    __m256d carry = zero;
+    int i = 1;
+    for (; i + 4 <= numDays; i += 4) {
+        __m256d logReturn = _mm256_add_pd(_mm256_set1_pd(drift), _mm256_mul_pd(_mm256_set1_pd(diffusion), _mm256_loadu_pd(normals + i - 1)));
+
+        // In-register inclusive scan: add the vector shifted by one lane, then by two
+        logReturn = _mm256_add_pd(logReturn, _mm256_blend_pd(_mm256_permute4x64_pd(logReturn, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1));
+        logReturn = _mm256_add_pd(logReturn, _mm256_blend_pd(_mm256_permute4x64_pd(logReturn, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x3));
+        __m256d logSum = _mm256_add_pd(logReturn, carry);
+        carry = _mm256_permute4x64_pd(logSum, _MM_SHUFFLE(3, 3, 3, 3));
+
+        __m256d price = _mm256_mul_pd(_mm256_set1_pd(start), expAvx2(logSum));
+        _mm256_storeu_pd(prices + i, roundPriceAvx2(price));
+    }
+    simulateLogSpaceScalar(start, drift, diffusion, normals, i, numDays, _mm256_cvtsd_f64(carry), prices);
+}
+
+__attribute__((target("sse4.1")))
+static __m128d expSse41(__m128d x)
+{
+    x = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(EXP_MIN_ARGUMENT)), _mm_set1_pd(EXP_MAX_ARGUMENT));
+    __m128d n = _mm_round_pd(_mm_mul_pd(x, _mm_set1_pd(LOG2_E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m128d r = _mm_sub_pd(x, _mm_mul_pd(n, _mm_set1_pd(LN2_HIGH)));
+    r = _mm_sub_pd(r, _mm_mul_pd(n, _mm_set1_pd(LN2_LOW)));
+
+    __m128d polynomial = _mm_set1_pd(EXP_COEFFICIENTS[EXP_POLYNOMIAL_DEGREE]);
+    for (int k = EXP_POLYNOMIAL_DEGREE - 1; k >= 0; k--) {
+        polynomial = _mm_add_pd(_mm_mul_pd(polynomial, r), _mm_set1_pd(EXP_COEFFICIENTS[k]));
+    }
+
+    __m128i exponent = _mm_cvtepi32_epi64(_mm_cvtpd_epi32(n));
+    exponent = _mm_slli_epi64(_mm_add_epi64(exponent, _mm_set1_epi64x(EXPONENT_BIAS)), 52);
+    return _mm_mul_pd(polynomial, _mm_castsi128_pd(exponent));
+}
+
+__attribute__((target("sse4.1")))
+static __m128d roundPriceSse41(__m128d price)
+{
+    __m128d scaled = _mm_mul_pd(price, _mm_set1_pd(PRICE_SCALE));
+    __m128d truncated = _mm_round_pd(scaled, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m128d fraction = _mm_sub_pd(scaled, truncated);
+    __m128d one = _mm_set1_pd(1.0);
+    truncated = _mm_add_pd(truncated, _mm_and_pd(_mm_cmpge_pd(fraction, _mm_set1_pd(0.5)), one));
+    truncated = _mm_sub_pd(truncated, _mm_and_pd(_mm_cmple_pd(fraction, _mm_set1_pd(-0.5)), one));
+    return _mm_div_pd(truncated, _mm_set1_pd(PRICE_SCALE));
+}
+
+__attribute__((target("sse4.1")))
+static void simulateLogSpaceSse41(double initialPrice, double drift, double diffusion, const double *normals, int numDays, double *prices)
+{
+    double start = roundPrice(initialPrice);
+    prices[0] = start;
+
+    __m128d zero = _mm_setzero_pd();
+    __m128d carry = zero;
+    int i = 1;
+    for (; i + 2 <= numDays; i += 2) {
+        __m128d logReturn = _mm_add_pd(_mm_set1_pd(drift), _mm_mul_pd(_mm_set1_pd(diffusion), _mm_loadu_pd(normals + i - 1)));
+        logReturn = _mm_add_pd(logReturn, _mm_shuffle_pd(zero, logReturn, 0x0));
+        __m128d logSum = _mm_add_pd(logReturn, carry);
+        carry = _mm_unpackhi_pd(logSum, logSum);
+
+        __m128d price = _mm_mul_pd(_mm_set1_pd(start), expSse41(logSum));
+        _mm_storeu_pd(prices + i, roundPriceSse41(price));
+    }
+    simulateLogSpaceScalar(start, drift, diffusion, normals, i, numDays, _mm_cvtsd_f64(carry), prices);
+}
+
+#endif // GBM_KERNEL_X86
+
+GbmKernel::InstructionSet GbmKernel::bestAvailable()
+{
+#ifdef GBM_KERNEL_X86
+    static const InstructionSet detected = __builtin_cpu_supports("avx2") ? AVX2
+                                         : __builtin_cpu_supports("sse4.1") ? SSE41
+                                         : SCALAR;
+    return detected;
+#else
+    return SCALAR;
+#endif
+}
+
+const char *GbmKernel::name(InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+    case AVX2:
+        return "avx2";
+    case SSE41:
+        return "sse4.1";
+    default:
+        return "scalar";
+    }
+}
+
+void GbmKernel::simulatePath(double initialPrice, double drift, double diffusion, const double *normals,
+                             int numDays, bool exactRounding, double *prices)
+{
+    simulatePath(initialPrice, drift, diffusion, normals, numDays, exactRounding, prices, bestAvailable());
+}
+
+void GbmKernel::simulatePath(double initialPrice, double drift, double diffusion, const double *normals,
+                             int numDays, bool exactRounding, double *prices, InstructionSet instructionSet)
+{
+    if (numDays <= 0) {
+        return;
+    }
+    if (exactRounding) {
+        simulateExact(initialPrice, drift, diffusion, normals, numDays, prices);
+        return;
+    }
+
+    // Never run code the CPU cannot execute, whatever the caller asked for
+    if (instructionSet > bestAvailable()) {
+        instructionSet = bestAvailable();
+    }
+#ifdef GBM_KERNEL_X86
+    if (instructionSet == AVX2) {
+        simulateLogSpaceAvx2(initialPrice, drift, diffusion, normals, numDays, prices);
+        return;
+    }
+    if (instructionSet == SSE41) {
+        simulateLogSpaceSse41(initialPrice, drift, diffusion, normals, numDays, prices);
+        return;
+    }
+#endif
+    double start = roundPrice(initialPrice);
+    prices[0] = start;
+    simulateLogSpaceScalar(start, drift, diffusion, normals, 1, numDays, 0.0, prices);
+}
@@ -0,0 +1,33 @@
+#ifndef GBM_KERNEL_H
+#define GBM_KERNEL_H
+
+using namespace std;
+
+// Turns a batch of standard normal draws into one GBM price path rounded to 3 decimals,
+// shared by Market::simulate and MarketEnsemble.
+//
+// Exact rounding reproduces Market::simulate bit for bit: every day's price is rounded
+// before it is compounded into the next, which makes the path an inherently serial chain.
+// Without it the path is computed as initial * exp(prefix sum of log returns), with the
+// prefix sum, exp and rounding done in SIMD passes (AVX2 or SSE4.1, chosen at run time).
+// Each day is then rounded only for output, so prices can differ from the exact chain in
+// the last decimal.
+class GbmKernel
+{
+public:
+    enum InstructionSet { SCALAR, SSE41, AVX2 };
+
+    // Widest instruction set this CPU supports (always SCALAR off x86)
+    static InstructionSet bestAvailable();
+    static const char *name(InstructionSet instructionSet);
+
+    // Fills prices[0, numDays). normals holds the numDays - 1 draws for days 1.. and may
+    // alias prices + 1, so callers can generate the draws in place. drift and diffusion are
+    // the per-day constants (mu - sigma^2 / 2) * dt and sigma * sqrt(dt).
+    static void simulatePath(double initialPrice, double drift, double diffusion, const double *normals,
+                             int numDays, bool exactRounding, double *prices);
+    static void simulatePath(double initialPrice, double drift, double diffusion, const double *normals,
+                             int numDays, bool exactRounding, double *prices, InstructionSet instructionSet);
+};
+
+#endif // GBM_KERNEL_H
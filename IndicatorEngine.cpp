@@ -0,0 +1,300 @@
+#include "IndicatorEngine.h"
+#include "Instrumentation.h"
+#include <cmath>
+#include <limits>
+
+// Reference moving average, kept in step with Strategy::calculateMovingAverage so that
+// cached tables and out-of-range lookups agree with it exactly.
+static double directSimpleAverage(Market *market, PriceView prices, int index, int window)
+{
+    if (market == nullptr) {
+        return 0.0;
+    }
+
+    if (index < 0 || window <= 0) {
+        return market->getPrice(max(0, index));
+    }
+
+    double sum = 0.0;
+    int startIdx = max(index - window + 1, 0);
+    int lastIdx = min(index, prices.size() - 1);
+    int count = index - startIdx + 1;
+
+    for (int i = startIdx; i <= lastIdx; i++) {
+        sum += prices[i];
+    }
+
+    return count > 0 ? sum / count : market->getPrice(index);
+}
+
+// Reference weighted average, kept in step with WeightedTrendFollowingStrategy's per-call
+// one (weights growing from the oldest day, summed oldest-to-newest) so that out-of-range
+// lookups and rechecked table entries agree with it exactly.
+static double directWeightedAverage(Market *market, PriceView prices, int index, int window)
+{
+    if (market == nullptr) {
+        return 0.0;
+    }
+
+    if (index < 0 || window <= 0) {
+        return market->getPrice(max(0, index));
+    }
+
+    int startIdx = max(index - window + 1, 0);
+    double weight = 1.0;
+    double weightedSum = 0.0;
+    double totalWeight = 0.0;
+    for (int i = startIdx; i <= index; i++) {
+        weightedSum += (i < prices.size() ? prices[i] : 0.0) * weight;
+        totalWeight += weight;
+        weight *= IndicatorEngine::WEIGHT_GROWTH_FACTOR;
+    }
+
+    if (totalWeight <= 0.0) {
+        return market->getPrice(index);
+    }
+
+    return weightedSum / totalWeight;
+}
+
+const double IndicatorEngine::WEIGHT_GROWTH_FACTOR = 1.1;
+
+IndicatorEngine::IndicatorEngine(Market *market, int firstIndex, int endIndex)
+: market(market), prices(market != nullptr ? market->getPriceView() : PriceView()), firstIndex(max(firstIndex, 0)), endIndex(min(endIndex, prices.size())), frozen(false){
+    if (this->endIndex < this->firstIndex) {
+        this->endIndex = this->firstIndex;
+    }
+}
+
+Market *IndicatorEngine::getMarket() const
+{
+    return market;
+}
+
+PriceView IndicatorEngine::getPrices() const
+{
+    return prices;
+}
+
+int IndicatorEngine::getFirstIndex() const
+{
+    return firstIndex;
+}
+
+int IndicatorEngine::getEndIndex() const
+{
+    return endIndex;
+}
+
+bool IndicatorEngine::covers(int index) const
+{
+    return index >= firstIndex && index < endIndex;
+}
+
+void IndicatorEngine::freeze()
+{
+    frozen = true;
+}
+
+bool IndicatorEngine::isFrozen() const
+{
+    return frozen;
+}
+
+const vector<double> &IndicatorEngine::simpleAverageTable(int window)
+{
+    unordered_map<int, vector<double>>::iterator found = simpleAverages.find(window);
+    if (found != simpleAverages.end()) {
+        return found->second;
+    }
+
+    INSTRUMENT_SCOPE("IndicatorEngine::simpleAverageTable");
+    INSTRUMENT_ITEMS("days", endIndex - firstIndex);
+
+    // Each entry is summed oldest-to-newest, the same order the per-call average uses,
+    // so the cached values are bit-identical to it.
+    vector<double> &table = simpleAverages[window];
+    table.resize(endIndex - firstIndex);
+    for (int index = firstIndex; index < endIndex; index++) {
+        int startIdx = max(index - window + 1, 0);
+        double sum = 0.0;
+        for (int i = startIdx; i <= index; i++) {
+            sum += prices[i];
+        }
+        table[index - firstIndex] = sum / (index - startIdx + 1);
+    }
+    return table;
+}
+
+const vector<double> &IndicatorEngine::weightedAverageTable(int window)
+{
+    unordered_map<int, vector<double>>::iterator found = weightedAverages.find(window);
+    if (found != weightedAverages.end()) {
+        return found->second;
+    }
+
+    INSTRUMENT_SCOPE("IndicatorEngine::weightedAverageTable");
+    INSTRUMENT_ITEMS("days", endIndex - firstIndex);
+
+    // Rolling form of the normalised weighted sum: every day the old sum decays by 1/growth,
+    // the new price enters with weight 1 and, once the window is full, the price leaving it
+    // is removed with weight decay^window. The sums are recomputed from scratch every
+    // refreshInterval days so rounding error cannot accumulate; that costs O(window) at most
+    // once per window's worth of days, keeping each update O(1) amortised.
+    const double decay = 1.0 / WEIGHT_GROWTH_FACTOR;
+    const int refreshInterval = max(window, 64);
+    double leavingWeight = 1.0;
+    for (int k = 0; k < window && leavingWeight > 0.0; k++) {
+        leavingWeight *= decay;
+    }
+
+    // Each step of the rolling sums errs by a few eps times the largest price times the
+    // total weight (below growth / (growth - 1) = 11), and those errors add up until the
+    // next refresh; the reference's window-long sum errs by about its term count times
+    // the same. The bound below is several times that. Non-finite prices, or reference
+    // weights that overflow, make every entry uncertain.
+    double largestPrice = 0.0;
+    for (int i = max(firstIndex - window + 1, 0); i < endIndex; i++) {
+        double magnitude = fabs(prices[i]);
+        largestPrice = magnitude > largestPrice || magnitude != magnitude ? magnitude : largestPrice;
+    }
+    double largestWeight = pow(WEIGHT_GROWTH_FACTOR, window);
+    double baseTolerance = 256.0 * numeric_limits<double>::epsilon() * largestPrice;
+    if (!std::isfinite(baseTolerance) || !std::isfinite(largestPrice * largestWeight * 16.0)) {
+        baseTolerance = numeric_limits<double>::infinity();
+    }
+
+    vector<double> &table = weightedAverages[window];
+    vector<double> &tolerance = weightedTolerances[window];
+    table.resize(endIndex - firstIndex);
+    tolerance.resize(endIndex - firstIndex);
+    double weightedSum = 0.0;
+    double totalWeight = 0.0;
+    int sinceRefresh = refreshInterval;
+    for (int index = firstIndex; index < endIndex; index++) {
+        int startIdx = max(index - window + 1, 0);
+        if (sinceRefresh >= refreshInterval) {
+            weightedSum = 0.0;
+            totalWeight = 0.0;
+            double weight = 1.0;
+            for (int i = index; i >= startIdx; i--) {
+                weightedSum += prices[i] * weight;
+                totalWeight += weight;
+                weight *= decay;
+            }
+            sinceRefresh = 0;
+        } else {
+            weightedSum = prices[index] + decay * weightedSum;
+            totalWeight = 1.0 + decay * totalWeight;
+            if (index - window >= 0) {
+                weightedSum -= leavingWeight * prices[index - window];
+                totalWeight -= leavingWeight;
+            }
+        }
+        sinceRefresh++;
+        table[index - firstIndex] = weightedSum / totalWeight;
+        tolerance[index - firstIndex] = baseTolerance * (sinceRefresh + 2 * window + 4);
+    }
+
+    // WeightedTrendFollowing compares two of these tables day by day. Where a pair is
+    // within its bounds of each other, the comparison could come out differently from the
+    // reference averages, so both entries are replaced by the reference value (bound 0).
+    // Every other pair is far enough apart to compare like the reference.
+    int days = endIndex - firstIndex;
+    for (unordered_map<int, vector<double>>::iterator other = weightedAverages.begin(); other != weightedAverages.end(); ++other) {
+        if (other->first == window) {
+            continue;
+        }
+        vector<double> &otherTable = other->second;
+        vector<double> &otherTolerance = weightedTolerances[other->first];
+        // Branch-free count first, so the compiler vectorizes the common no-tie case
+        int close = 0;
+        for (int day = 0; day < days; day++) {
+            close += !(fabs(table[day] - otherTable[day]) > tolerance[day] + otherTolerance[day]);
+        }
+        for (int day = 0; close > 0 && day < days; day++) {
+            if (!(fabs(table[day] - otherTable[day]) > tolerance[day] + otherTolerance[day])) {
+                recheckWeightedEntry(table, tolerance, day, window);
+                recheckWeightedEntry(otherTable, otherTolerance, day, other->first);
+                close--;
+            }
+        }
+    }
+    return table;
+}
+
+void IndicatorEngine::recheckWeightedEntry(vector<double> &table, vector<double> &tolerance, int day, int window) const
+{
+    if (tolerance[day] != 0.0) {
+        table[day] = directWeightedAverage(market, prices, firstIndex + day, window);
+        tolerance[day] = 0.0;
+    }
+}
+
+void IndicatorEngine::requireSimpleAverage(int window)
+{
+    if (!frozen && window > 0 && endIndex > firstIndex) {
+        simpleAverageTable(window);
+    }
+}
+
+double IndicatorEngine::simpleMovingAverage(int index, int window)
+{
+    if (window <= 0 || !covers(index)) {
+        return directSimpleAverage(market, prices, index, window);
+    }
+    if (frozen) {
+        unordered_map<int, vector<double>>::const_iterator found = simpleAverages.find(window);
+        if (found == simpleAverages.end()) {
+            return directSimpleAverage(market, prices, index, window);
+        }
+        return found->second[index - firstIndex];
+    }
+    return simpleAverageTable(window)[index - firstIndex];
+}
+
+void IndicatorEngine::requireWeightedAverage(int window)
+{
+    if (!frozen && window > 0 && endIndex > firstIndex) {
+        weightedAverageTable(window);
+    }
+}
+
+double IndicatorEngine::weightedMovingAverage(int index, int window)
+{
+    if (window <= 0 || !covers(index)) {
+        return directWeightedAverage(market, prices, index, window);
+    }
+    if (frozen) {
+        unordered_map<int, vector<double>>::const_iterator found = weightedAverages.find(window);
+        if (found == weightedAverages.end()) {
+            return directWeightedAverage(market, prices, index, window);
+        }
+        return found->second[index - firstIndex];
+    }
+    return weightedAverageTable(window)[index - firstIndex];
+}
+
+const double *IndicatorEngine::simpleAverageSeries(int window)
+{
+    if (window <= 0 || endIndex == firstIndex) {
+        return nullptr;
+    }
+    if (frozen) {
+        unordered_map<int, vector<double>>::const_iterator found = simpleAverages.find(window);
+        return found != simpleAverages.end() ? found->second.data() : nullptr;
+    }
+    return simpleAverageTable(window).data();
+}
+
+const double *IndicatorEngine::weightedAverageSeries(int window)
+{
+    if (window <= 0 || endIndex == firstIndex) {
+        return nullptr;
+    }
+    if (frozen) {
+        unordered_map<int, vector<double>>::const_iterator found = weightedAverages.find(window);
+        return found != weightedAverages.end() ? found->second.data() : nullptr;
+    }
+    return weightedAverageTable(window).data();
+}
@@ -0,0 +1,67 @@
+#ifndef INDICATOR_ENGINE_H
+#define INDICATOR_ENGINE_H
+
+#include <unordered_map>
+#include <vector>
+#include "Market.h"
+#include "PriceSeries.h"
+
+using namespace std;
+
+// Per-market cache of indicator series over a fixed day range [firstIndex, endIndex).
+// Each moving-average window is computed once and then shared by every strategy that
+// asks for it, so a lookup inside a backtest is O(1) instead of O(window).
+class IndicatorEngine
+{
+private:
+    Market *market;
+    PriceView prices;
+    int firstIndex;
+    int endIndex;
+    unordered_map<int, vector<double>> simpleAverages;
+    unordered_map<int, vector<double>> weightedAverages;
+    unordered_map<int, vector<double>> weightedTolerances; // bound on |entry - reference| per day
+    bool frozen;
+
+    const vector<double> &simpleAverageTable(int window);
+    const vector<double> &weightedAverageTable(int window);
+    void recheckWeightedEntry(vector<double> &table, vector<double> &tolerance, int day, int window) const;
+
+public:
+    // Per-day growth of the weights used by weightedMovingAverage (newest day weighs most)
+    static const double WEIGHT_GROWTH_FACTOR;
+
+    IndicatorEngine(Market *market, int firstIndex, int endIndex);
+
+    Market *getMarket() const;
+    PriceView getPrices() const;
+    int getFirstIndex() const;
+    int getEndIndex() const;
+    bool covers(int index) const;
+
+    // Stops building new tables so that lookups never modify the engine and can run from
+    // several threads at once. Windows nobody registered are then computed per call.
+    void freeze();
+    bool isFrozen() const;
+
+    // Builds the table ahead of time; lookups would otherwise build it on first use
+    void requireSimpleAverage(int window);
+
+    // Same result, bit for bit, as Strategy::calculateMovingAverage(market, index, window)
+    double simpleMovingAverage(int index, int window);
+
+    void requireWeightedAverage(int window);
+
+    // Exponentially weighted average matching WeightedTrendFollowingStrategy to within
+    // rounding. Wherever two cached windows come within rounding of each other on a day,
+    // both hold the strategy's exact value, so comparing them decides like the strategy.
+    double weightedMovingAverage(int index, int window);
+
+    // Whole cached tables for callers that scan many days: entry index - getFirstIndex()
+    // holds the value for day index. nullptr for non-positive windows and, once frozen,
+    // for windows that were never required.
+    const double *simpleAverageSeries(int window);
+    const double *weightedAverageSeries(int window);
+};
+
+#endif // INDICATOR_ENGINE_H
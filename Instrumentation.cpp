@@ -0,0 +1,214 @@
+#include "Instrumentation.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+struct TraceEvent
+{
+    const InstrumentSite *site;
+    long long startNanoseconds; // since the trace origin
+    long long durationNanoseconds;
+};
+
+struct TraceBuffer
+{
+    int threadId;
+    vector<TraceEvent> events;
+    long long dropped;
+};
+
+atomic<InstrumentSite *> siteList(nullptr);
+
+// Trace buffers outlive their threads so events survive until writeTrace
+mutex traceLock;
+vector<shared_ptr<TraceBuffer>> traceBuffers;
+atomic<size_t> traceCapacity(1 << 20);
+atomic<long long> traceOriginNanoseconds(0);
+atomic<unsigned> traceGeneration(0); // bumped by reset so threads drop stale buffers
+
+long long sinceEpoch(chrono::steady_clock::time_point time)
+{
+    return chrono::duration_cast<chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+TraceBuffer &threadBuffer()
+{
+    thread_local shared_ptr<TraceBuffer> buffer;
+    thread_local unsigned generation = 0;
+    unsigned current = traceGeneration.load(memory_order_acquire);
+    if (!buffer || generation != current) {
+        lock_guard<mutex> guard(traceLock);
+        buffer = make_shared<TraceBuffer>();
+        buffer->threadId = static_cast<int>(traceBuffers.size()) + 1;
+        buffer->dropped = 0;
+        traceBuffers.push_back(buffer);
+        generation = current;
+    }
+    return *buffer;
+}
+
+string escapeJson(const char *text)
+{
+    string escaped;
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            escaped += '\\';
+        }
+        escaped += *c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+atomic<bool> Instrumentation::tracing(false);
+
+InstrumentSite::InstrumentSite(const char *name)
+: name(name), calls(0), nanoseconds(0), next(nullptr){
+    for (int k = 0; k < MAX_COUNTERS; k++) {
+        counterLabels[k].store(nullptr, memory_order_relaxed);
+        counters[k].store(0, memory_order_relaxed);
+    }
+}
+
+void InstrumentSite::addItems(const char *label, long long count)
+{
+    // Labels are string literals, so the pointer usually identifies them; the first thread
+    // to count a label claims the next free slot for it
+    for (int k = 0; k < MAX_COUNTERS; k++) {
+        const char *existing = counterLabels[k].load(memory_order_acquire);
+        if (existing == nullptr && counterLabels[k].compare_exchange_strong(existing, label, memory_order_acq_rel)) {
+            existing = label;
+        }
+        if (existing == label || strcmp(existing, label) == 0) {
+            counters[k].fetch_add(count, memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+bool Instrumentation::isCompiledIn()
+{
+#ifdef TRADING_INSTRUMENT
+    return true;
+#else
+    return false;
+#endif
+}
+
+InstrumentSite *Instrumentation::registerSite(InstrumentSite *site)
+{
+    InstrumentSite *head = siteList.load(memory_order_relaxed);
+    do {
+        site->next = head;
+    } while (!siteList.compare_exchange_weak(head, site, memory_order_release, memory_order_relaxed));
+    return site;
+}
+
+void Instrumentation::setTracing(bool enabled, size_t maxEventsPerThread)
+{
+    if (enabled && !tracing.load()) {
+        traceCapacity.store(maxEventsPerThread);
+        traceOriginNanoseconds.store(sinceEpoch(chrono::steady_clock::now()));
+    }
+    tracing.store(enabled);
+}
+
+void Instrumentation::recordEvent(const InstrumentSite *site, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end)
+{
+    TraceBuffer &buffer = threadBuffer();
+    if (buffer.events.size() >= traceCapacity.load(memory_order_relaxed)) {
+        buffer.dropped++;
+        return;
+    }
+    TraceEvent event;
+    event.site = site;
+    event.startNanoseconds = sinceEpoch(start) - traceOriginNanoseconds.load(memory_order_relaxed);
+    event.durationNanoseconds = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+    buffer.events.push_back(event);
+}
+
+void Instrumentation::reset()
+{
+    for (InstrumentSite *site = siteList.load(memory_order_acquire); site != nullptr; site = site->next) {
+        site->calls.store(0, memory_order_relaxed);
+        site->nanoseconds.store(0, memory_order_relaxed);
+        for (int k = 0; k < InstrumentSite::MAX_COUNTERS; k++) {
+            site->counters[k].store(0, memory_order_relaxed);
+        }
+    }
+    lock_guard<mutex> guard(traceLock);
+    traceBuffers.clear();
+    traceGeneration.fetch_add(1, memory_order_release);
+    traceOriginNanoseconds.store(sinceEpoch(chrono::steady_clock::now()));
+}
+
+void Instrumentation::printSummary(ostream &out)
+{
+    vector<InstrumentSite *> sites;
+    for (InstrumentSite *site = siteList.load(memory_order_acquire); site != nullptr; site = site->next) {
+        if (site->calls.load(memory_order_relaxed) > 0) {
+            sites.push_back(site);
+        }
+    }
+    stable_sort(sites.begin(), sites.end(), [](const InstrumentSite *a, const InstrumentSite *b) {
+        return a->nanoseconds.load(memory_order_relaxed) > b->nanoseconds.load(memory_order_relaxed);
+    });
+    if (sites.empty() && !isCompiledIn()) {
+        out << "Instrumentation is compiled out (build with make INSTRUMENT=1)" << endl;
+        return;
+    }
+
+    out << "| Site | Calls | Total (ms) | Mean (ns) | Items |" << endl;
+    out << "|---|---|---|---|---|" << endl;
+    for (const InstrumentSite *site : sites) {
+        long long calls = site->calls.load(memory_order_relaxed);
+        double seconds = site->nanoseconds.load(memory_order_relaxed) * 1e-9;
+        ostringstream items;
+        for (int k = 0; k < InstrumentSite::MAX_COUNTERS; k++) {
+            const char *label = site->counterLabels[k].load(memory_order_acquire);
+            if (label == nullptr) {
+                break;
+            }
+            long long count = site->counters[k].load(memory_order_relaxed);
+            items << (k > 0 ? ", " : "") << count << ' ' << label;
+            if (seconds > 0.0) {
+                items << " (" << setprecision(3) << count / seconds << "/s)";
+            }
+        }
+        out << "| " << site->name << " | " << calls << " | " << fixed << setprecision(3) << seconds * 1e3 << " | "
+            << setprecision(0) << seconds * 1e9 / calls << " | " << items.str() << " |" << endl;
+        out.unsetf(ios::floatfield);
+    }
+}
+
+bool Instrumentation::writeTrace(const string &path)
+{
+    ofstream out(path);
+    if (!out) {
+        cerr << "Error opening file for writing: " << path << endl;
+        return false;
+    }
+    lock_guard<mutex> guard(traceLock);
+    long long dropped = 0;
+    bool first = true;
+    out << "{\"traceEvents\":[" << fixed << setprecision(3);
+    for (const shared_ptr<TraceBuffer> &buffer : traceBuffers) {
+        for (const TraceEvent &event : buffer->events) {
+            out << (first ? "\n" : ",\n") << "{\"name\":\"" << escapeJson(event.site->name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << buffer->threadId << ",\"ts\":" << event.startNanoseconds * 1e-3 << ",\"dur\":" << event.durationNanoseconds * 1e-3 << "}";
+            first = false;
+        }
+        dropped += buffer->dropped;
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":" << dropped << "}}" << endl;
+    return static_cast<bool>(out);
+}
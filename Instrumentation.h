@@ -0,0 +1,112 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+// Hot-path timers and counters, compiled in only when TRADING_INSTRUMENT is defined (make
+// INSTRUMENT=1). Without it the INSTRUMENT_* macros expand to nothing, so instrumented
+// functions compile exactly as before.
+//
+//   void Market::simulate()
+//   {
+//       INSTRUMENT_SCOPE("Market::simulate");   // times the rest of the block
+//       ...
+//       INSTRUMENT_ITEMS("days", numTradingDays);  // counted against this scope's time
+//   }
+//
+// At most one INSTRUMENT_SCOPE per block. Every scope name gets one InstrumentSite holding
+// its call count, total time and up to MAX_COUNTERS item counters, updated with relaxed
+// atomics so sites can be hit from any thread. Nested scopes count their time in both
+// sites. Instrumentation::printSummary() prints one row per site with item rates per
+// second of the site's own time, and setTracing(true) also records every scope as a
+// Chrome trace event for writeTrace().
+
+struct InstrumentSite
+{
+    static const int MAX_COUNTERS = 2;
+
+    const char *name;
+    atomic<long long> calls;
+    atomic<long long> nanoseconds;
+    atomic<const char *> counterLabels[MAX_COUNTERS];
+    atomic<long long> counters[MAX_COUNTERS];
+    InstrumentSite *next; // registration list, newest first
+
+    explicit InstrumentSite(const char *name);
+
+    void addItems(const char *label, long long count);
+};
+
+class Instrumentation
+{
+private:
+    static atomic<bool> tracing;
+
+public:
+    // True in builds compiled with TRADING_INSTRUMENT
+    static bool isCompiledIn();
+
+    // Records every timed scope as a trace event, up to maxEventsPerThread per thread
+    static void setTracing(bool enabled, size_t maxEventsPerThread = 1 << 20);
+    static bool isTracing() { return tracing.load(memory_order_relaxed); }
+
+    // Zeroes every site and drops recorded trace events; call while no timed scope is running
+    static void reset();
+
+    // Table of sites with calls, total and mean time and item rates, busiest first
+    static void printSummary(ostream &out);
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto); false if the file cannot be written
+    static bool writeTrace(const string &path);
+
+    static InstrumentSite *registerSite(InstrumentSite *site);
+    static void recordEvent(const InstrumentSite *site, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end);
+};
+
+// Adds the time from construction to destruction to its site
+class ScopedTimer
+{
+private:
+    InstrumentSite *site;
+    chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(InstrumentSite *site) : site(site), start(chrono::steady_clock::now()) {}
+
+    ~ScopedTimer()
+    {
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+        site->calls.fetch_add(1, memory_order_relaxed);
+        site->nanoseconds.fetch_add(chrono::duration_cast<chrono::nanoseconds>(end - start).count(), memory_order_relaxed);
+        if (Instrumentation::isTracing()) {
+            Instrumentation::recordEvent(site, start, end);
+        }
+    }
+
+    void addItems(const char *label, long long count) { site->addItems(label, count); }
+
+    // Prevent copying
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+};
+
+#ifdef TRADING_INSTRUMENT
+#define INSTRUMENT_SCOPE(name)                                                                        \
+    static InstrumentSite *instrumentSite = Instrumentation::registerSite(new InstrumentSite(name)); \
+    ScopedTimer instrumentScope(instrumentSite)
+#define INSTRUMENT_ITEMS(label, count) instrumentScope.addItems(label, count)
+#else
+#define INSTRUMENT_SCOPE(name) \
+    do {                       \
+    } while (0)
+#define INSTRUMENT_ITEMS(label, count) \
+    do {                               \
+    } while (0)
+#endif
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,76 @@
+#include "LatencyHistogram.h"
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+: sampleCount(0), maxNanoseconds(0){
+}
+
+int LatencyHistogram::bucketOf(uint64_t nanoseconds)
+{
+    if (nanoseconds < LINEAR_LIMIT) {
+        return static_cast<int>(nanoseconds);
+    }
+    int exponent = 63 - __builtin_clzll(nanoseconds);
+    int subBucket = static_cast<int>(nanoseconds >> (exponent - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1);
+    return LINEAR_LIMIT + ((exponent - 4) << SUB_BUCKET_BITS) + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket < LINEAR_LIMIT) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int exponent = 4 + ((bucket - LINEAR_LIMIT) >> SUB_BUCKET_BITS);
+    uint64_t subBucket = static_cast<uint64_t>((bucket - LINEAR_LIMIT) & ((1 << SUB_BUCKET_BITS) - 1));
+    int shift = exponent - SUB_BUCKET_BITS;
+    return (((1ULL << SUB_BUCKET_BITS) + subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds)
+{
+    size_t bucket = static_cast<size_t>(bucketOf(nanoseconds));
+    if (bucket >= counts.size()) {
+        counts.resize(bucket + 1, 0);
+    }
+    counts[bucket]++;
+    sampleCount++;
+    if (nanoseconds > maxNanoseconds) {
+        maxNanoseconds = nanoseconds;
+    }
+}
+
+void LatencyHistogram::clear()
+{
+    counts.clear();
+    sampleCount = 0;
+    maxNanoseconds = 0;
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+    return sampleCount;
+}
+
+uint64_t LatencyHistogram::getMax() const
+{
+    return maxNanoseconds;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if (sampleCount == 0) {
+        return 0;
+    }
+    double wanted = ceil(fraction * static_cast<double>(sampleCount));
+    uint64_t rank = wanted < 1.0 ? 1 : static_cast<uint64_t>(wanted);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < counts.size(); bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            // The top bucket's bound can overshoot the largest sample
+            uint64_t bound = bucketUpperBound(static_cast<int>(bucket));
+            return bound < maxNanoseconds ? bound : maxNanoseconds;
+        }
+    }
+    return maxNanoseconds;
+}
@@ -0,0 +1,38 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Log-linear histogram of durations in nanoseconds: exact below 16 ns, then 8 buckets per
+// power of two, so any percentile is known to within 12.5% from a few hundred counters
+// however many samples are recorded. Recording is O(1) and allocation-free once the
+// largest bucket seen has been reached.
+class LatencyHistogram
+{
+private:
+    static const int LINEAR_LIMIT = 16;
+    static const int SUB_BUCKET_BITS = 3;
+
+    vector<uint64_t> counts;
+    uint64_t sampleCount;
+    uint64_t maxNanoseconds;
+
+    static int bucketOf(uint64_t nanoseconds);
+    static uint64_t bucketUpperBound(int bucket);
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t nanoseconds);
+    void clear();
+
+    uint64_t getCount() const;
+    uint64_t getMax() const;
+    // Smallest bucket bound at or above a fraction (0..1) of the samples; 0 when empty
+    uint64_t percentile(double fraction) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,222 @@
+#include "Leaderboard.h"
+#include <algorithm>
+
+Leaderboard::Leaderboard(int capacity)
+: capacity(capacity > 0 ? capacity : 0), candidatesSeen(0){
+}
+
+void Leaderboard::clear()
+{
+    candidatesSeen = 0;
+    ids.clear();
+    profits.clear();
+    tradeCounts.clear();
+    winRates.clear();
+    maxDrawdowns.clear();
+    exposureDays.clear();
+    heap.clear();
+}
+
+bool Leaderboard::ranksAbove(long long idA, double profitA, long long idB, double profitB) const
+{
+    if (profitA != profitB) {
+        return profitA > profitB;
+    }
+    return idA < idB;
+}
+
+bool Leaderboard::rowRanksAbove(int rowA, int rowB) const
+{
+    return ranksAbove(ids[rowA], profits[rowA], ids[rowB], profits[rowB]);
+}
+
+void Leaderboard::writeRow(int row, long long id, const StrategyStats &stats)
+{
+    ids[row] = id;
+    profits[row] = stats.profit;
+    tradeCounts[row] = stats.tradeCount;
+    winRates[row] = stats.winRate();
+    maxDrawdowns[row] = stats.maxDrawdown;
+    exposureDays[row] = stats.exposureDays;
+}
+
+void Leaderboard::appendRow(long long id, const StrategyStats &stats)
+{
+    ids.push_back(id);
+    profits.push_back(stats.profit);
+    tradeCounts.push_back(stats.tradeCount);
+    winRates.push_back(stats.winRate());
+    maxDrawdowns.push_back(stats.maxDrawdown);
+    exposureDays.push_back(stats.exposureDays);
+}
+
+// Heap order: a parent never ranks above its children, so heap[0] is the worst kept row
+void Leaderboard::siftUp(int position)
+{
+    while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (!rowRanksAbove(heap[parent], heap[position])) {
+            break;
+        }
+        swap(heap[parent], heap[position]);
+        position = parent;
+    }
+}
+
+void Leaderboard::siftDown(int position)
+{
+    int count = static_cast<int>(heap.size());
+    while (true) {
+        int worst = position;
+        int left = 2 * position + 1;
+        int right = left + 1;
+        if (left < count && rowRanksAbove(heap[worst], heap[left])) {
+            worst = left;
+        }
+        if (right < count && rowRanksAbove(heap[worst], heap[right])) {
+            worst = right;
+        }
+        if (worst == position) {
+            break;
+        }
+        swap(heap[worst], heap[position]);
+        position = worst;
+    }
+}
+
+void Leaderboard::record(long long id, const StrategyStats &stats)
+{
+    candidatesSeen++;
+
+    if (capacity == 0) {
+        appendRow(id, stats);
+        return;
+    }
+
+    if (size() < capacity) {
+        appendRow(id, stats);
+        heap.push_back(size() - 1);
+        siftUp(static_cast<int>(heap.size()) - 1);
+        return;
+    }
+
+    // Full: the newcomer only gets in by beating the worst row, whose slot it reuses
+    int worstRow = heap[0];
+    if (ranksAbove(id, stats.profit, ids[worstRow], profits[worstRow])) {
+        writeRow(worstRow, id, stats);
+        siftDown(0);
+    }
+}
+
+void Leaderboard::sortByRank()
+{
+    vector<int> order(size());
+    for (int row = 0; row < size(); row++) {
+        order[row] = row;
+    }
+    sort(order.begin(), order.end(), [this](int a, int b) { return rowRanksAbove(a, b); });
+
+    vector<long long> sortedIds(size());
+    vector<double> sortedProfits(size());
+    vector<int> sortedTradeCounts(size());
+    vector<double> sortedWinRates(size());
+    vector<double> sortedMaxDrawdowns(size());
+    vector<int> sortedExposureDays(size());
+    for (int i = 0; i < size(); i++) {
+        sortedIds[i] = ids[order[i]];
+        sortedProfits[i] = profits[order[i]];
+        sortedTradeCounts[i] = tradeCounts[order[i]];
+        sortedWinRates[i] = winRates[order[i]];
+        sortedMaxDrawdowns[i] = maxDrawdowns[order[i]];
+        sortedExposureDays[i] = exposureDays[order[i]];
+    }
+    ids.swap(sortedIds);
+    profits.swap(sortedProfits);
+    tradeCounts.swap(sortedTradeCounts);
+    winRates.swap(sortedWinRates);
+    maxDrawdowns.swap(sortedMaxDrawdowns);
+    exposureDays.swap(sortedExposureDays);
+
+    if (capacity > 0) {
+        // Rows are best first, so reversed order is already a valid worst-on-top heap
+        heap.resize(size());
+        for (int i = 0; i < size(); i++) {
+            heap[i] = size() - 1 - i;
+        }
+    }
+}
+
+int Leaderboard::size() const
+{
+    return static_cast<int>(ids.size());
+}
+
+int Leaderboard::getCapacity() const
+{
+    return capacity;
+}
+
+long long Leaderboard::getCandidatesSeen() const
+{
+    return candidatesSeen;
+}
+
+long long Leaderboard::getId(int row) const
+{
+    return ids[row];
+}
+
+double Leaderboard::getProfit(int row) const
+{
+    return profits[row];
+}
+
+int Leaderboard::getTradeCount(int row) const
+{
+    return tradeCounts[row];
+}
+
+double Leaderboard::getWinRate(int row) const
+{
+    return winRates[row];
+}
+
+double Leaderboard::getMaxDrawdown(int row) const
+{
+    return maxDrawdowns[row];
+}
+
+int Leaderboard::getExposureDays(int row) const
+{
+    return exposureDays[row];
+}
+
+const vector<long long> &Leaderboard::getIds() const
+{
+    return ids;
+}
+
+const vector<double> &Leaderboard::getProfits() const
+{
+    return profits;
+}
+
+const vector<int> &Leaderboard::getTradeCounts() const
+{
+    return tradeCounts;
+}
+
+const vector<double> &Leaderboard::getWinRates() const
+{
+    return winRates;
+}
+
+const vector<double> &Leaderboard::getMaxDrawdowns() const
+{
+    return maxDrawdowns;
+}
+
+const vector<int> &Leaderboard::getExposureDays() const
+{
+    return exposureDays;
+}
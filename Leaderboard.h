@@ -0,0 +1,74 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <vector>
+
+using namespace std;
+
+// Outcome of backtesting one strategy over the evaluation window
+struct StrategyStats
+{
+    double profit;
+    int tradeCount;    // completed round trips, including the forced close at the end
+    int winningTrades; // round trips that sold above the buy price
+    double maxDrawdown; // largest peak-to-trough drop of the marked-to-market P&L
+    int exposureDays;  // days that ended with a position held
+
+    StrategyStats() : profit(0.0), tradeCount(0), winningTrades(0), maxDrawdown(0.0), exposureDays(0) {}
+
+    double winRate() const { return tradeCount > 0 ? static_cast<double>(winningTrades) / tradeCount : 0.0; }
+};
+
+// Per-strategy results stored column by column. Rows are ranked by profit (highest first),
+// with ties going to the lower id, so the ranking never depends on the order rows arrive in.
+// With a capacity of 0 every row is kept; otherwise only the best `capacity` rows are,
+// tracked through a min-heap so memory stays O(capacity) however many candidates are seen.
+class Leaderboard
+{
+private:
+    int capacity;
+    long long candidatesSeen;
+    vector<long long> ids;
+    vector<double> profits;
+    vector<int> tradeCounts;
+    vector<double> winRates;
+    vector<double> maxDrawdowns;
+    vector<int> exposureDays;
+    vector<int> heap; // row indices, worst-ranked row on top; bounded mode only
+
+    bool ranksAbove(long long idA, double profitA, long long idB, double profitB) const;
+    bool rowRanksAbove(int rowA, int rowB) const;
+    void writeRow(int row, long long id, const StrategyStats &stats);
+    void appendRow(long long id, const StrategyStats &stats);
+    void siftDown(int position);
+    void siftUp(int position);
+
+public:
+    explicit Leaderboard(int capacity = 0);
+
+    void clear();
+    void record(long long id, const StrategyStats &stats);
+
+    // Reorders the rows best first; the bounded heap is rebuilt afterwards
+    void sortByRank();
+
+    int size() const;
+    int getCapacity() const;
+    long long getCandidatesSeen() const;
+
+    long long getId(int row) const;
+    double getProfit(int row) const;
+    int getTradeCount(int row) const;
+    double getWinRate(int row) const;
+    double getMaxDrawdown(int row) const;
+    int getExposureDays(int row) const;
+
+    const vector<long long> &getIds() const;
+    const vector<double> &getProfits() const;
+    const vector<int> &getTradeCounts() const;
+    const vector<double> &getWinRates() const;
+    const vector<double> &getMaxDrawdowns() const;
+    const vector<int> &getExposureDays() const;
+};
+
+#endif // LEADERBOARD_H
@@ -0,0 +1,198 @@
+#include "LiveIndicators.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include "IndicatorEngine.h"
+
+LiveIndicators::LiveIndicators()
+: prices(1), largestPrice(0.0){
+}
+
+const double *LiveIndicators::registerAverage(int window, bool weighted)
+{
+    if (window <= 0) {
+        return nullptr;
+    }
+    unordered_map<int, RollingAverage *> &registered = weighted ? weightedAverages : simpleAverages;
+    unordered_map<int, RollingAverage *>::iterator found = registered.find(window);
+    if (found != registered.end()) {
+        return &found->second->value;
+    }
+
+    // A late window needs every price of its current window still in the ring
+    long long dayCount = prices.getDayCount();
+    if (dayCount > 0 && !prices.holds(max(dayCount - window, 0LL))) {
+        cerr << "Cannot add a moving average over " << window << " days after " << dayCount
+             << " prices: only the last " << prices.getCapacity() << " are kept" << endl;
+        return nullptr;
+    }
+    // Room for the window plus the price that leaves it next
+    prices.reserve(window + 1);
+
+    RollingAverage average;
+    average.window = window;
+    average.weighted = weighted;
+    average.refreshInterval = max(window, 64);
+    average.sinceRefresh = average.refreshInterval;
+    average.leavingWeight = 1.0;
+    if (weighted) {
+        double decay = 1.0 / IndicatorEngine::WEIGHT_GROWTH_FACTOR;
+        for (int k = 0; k < window && average.leavingWeight > 0.0; k++) {
+            average.leavingWeight *= decay;
+        }
+    }
+    average.sum = 0.0;
+    average.totalWeight = 0.0;
+    average.value = 0.0;
+    average.tolerance = 0.0;
+    averages.push_back(average);
+    RollingAverage &stored = averages.back();
+    registered[window] = &stored;
+    cells[&stored.value] = &stored;
+    if (dayCount > 0) {
+        recompute(stored, dayCount - 1);
+        stored.sinceRefresh = 1;
+        finishDay(stored);
+    }
+    return &stored.value;
+}
+
+// Exact sums for day, in the order IndicatorEngine's tables use
+void LiveIndicators::recompute(RollingAverage &average, long long day)
+{
+    long long startDay = max(day - average.window + 1, 0LL);
+    average.sum = 0.0;
+    average.totalWeight = 0.0;
+    if (average.weighted) {
+        double decay = 1.0 / IndicatorEngine::WEIGHT_GROWTH_FACTOR;
+        double weight = 1.0;
+        for (long long i = day; i >= startDay; i--) {
+            average.sum += prices[i] * weight;
+            average.totalWeight += weight;
+            weight *= decay;
+        }
+    } else {
+        for (long long i = startDay; i <= day; i++) {
+            average.sum += prices[i];
+        }
+        average.totalWeight = static_cast<double>(day - startDay + 1);
+    }
+    average.sinceRefresh = 0;
+}
+
+// O(1) step to day; the same rolling form IndicatorEngine uses for weighted tables
+void LiveIndicators::update(RollingAverage &average, long long day)
+{
+    if (average.sinceRefresh >= average.refreshInterval) {
+        recompute(average, day);
+    } else if (average.weighted) {
+        double decay = 1.0 / IndicatorEngine::WEIGHT_GROWTH_FACTOR;
+        average.sum = prices[day] + decay * average.sum;
+        average.totalWeight = 1.0 + decay * average.totalWeight;
+        if (day - average.window >= 0) {
+            average.sum -= average.leavingWeight * prices[day - average.window];
+            average.totalWeight -= average.leavingWeight;
+        }
+    } else {
+        average.sum += prices[day];
+        if (day - average.window >= 0) {
+            average.sum -= prices[day - average.window];
+        } else {
+            average.totalWeight += 1.0;
+        }
+    }
+    average.sinceRefresh++;
+    finishDay(average);
+}
+
+// Value and bound from the rolling sums. A simple step errs by a few eps times the window's
+// price total and a weighted one by a few eps times the largest price times the total weight
+// (below 11); those errors add up until the next refresh, and the reference's own sum errs
+// by about its term count times the same. The bounds are several times that, and infinite
+// for non-finite prices or reference weights that overflow.
+void LiveIndicators::finishDay(RollingAverage &average)
+{
+    average.value = average.sum / average.totalWeight;
+    double epsilon = numeric_limits<double>::epsilon();
+    int window = average.window;
+    if (average.weighted) {
+        double largestWeight = pow(IndicatorEngine::WEIGHT_GROWTH_FACTOR, window);
+        average.tolerance = 256.0 * epsilon * largestPrice * (average.sinceRefresh + 2 * window + 4);
+        if (!std::isfinite(largestPrice * largestWeight * 16.0)) {
+            average.tolerance = numeric_limits<double>::infinity();
+        }
+    } else {
+        average.tolerance = 32.0 * epsilon * largestPrice * (average.sinceRefresh + window + 2);
+    }
+}
+
+const double *LiveIndicators::toleranceOf(const double *cell) const
+{
+    unordered_map<const double *, RollingAverage *>::const_iterator found = cells.find(cell);
+    return found != cells.end() ? &found->second->tolerance : nullptr;
+}
+
+void LiveIndicators::settle(const double *cell)
+{
+    unordered_map<const double *, RollingAverage *>::iterator found = cells.find(cell);
+    long long day = prices.getDayCount() - 1;
+    if (found == cells.end() || day < 0 || found->second->tolerance == 0.0) {
+        return;
+    }
+    RollingAverage &average = *found->second;
+    long long startDay = max(day - average.window + 1, 0LL);
+    double sum = 0.0;
+    if (average.weighted) {
+        double weight = 1.0;
+        double totalWeight = 0.0;
+        for (long long i = startDay; i <= day; i++) {
+            sum += prices[i] * weight;
+            totalWeight += weight;
+            weight *= IndicatorEngine::WEIGHT_GROWTH_FACTOR;
+        }
+        average.value = totalWeight <= 0.0 ? prices[day] : sum / totalWeight;
+    } else {
+        for (long long i = startDay; i <= day; i++) {
+            sum += prices[i];
+        }
+        average.value = sum / (day - startDay + 1);
+    }
+    average.tolerance = 0.0;
+}
+
+const double *LiveIndicators::simpleAverage(int window)
+{
+    return registerAverage(window, false);
+}
+
+const double *LiveIndicators::weightedAverage(int window)
+{
+    return registerAverage(window, true);
+}
+
+void LiveIndicators::append(double price)
+{
+    prices.append(price);
+    double magnitude = fabs(price);
+    largestPrice = magnitude > largestPrice || magnitude != magnitude ? magnitude : largestPrice;
+    long long day = prices.getDayCount() - 1;
+    for (RollingAverage &average : averages) {
+        update(average, day);
+    }
+}
+
+const PriceRing &LiveIndicators::getPrices() const
+{
+    return prices;
+}
+
+long long LiveIndicators::getDayCount() const
+{
+    return prices.getDayCount();
+}
+
+int LiveIndicators::getAverageCount() const
+{
+    return static_cast<int>(averages.size());
+}
@@ -0,0 +1,74 @@
+#ifndef LIVE_INDICATORS_H
+#define LIVE_INDICATORS_H
+
+#include <deque>
+#include <unordered_map>
+#include "PriceRing.h"
+
+using namespace std;
+
+// Moving averages of a live feed, updated in O(1) amortised per price instead of being
+// recomputed over their window. Each registered window owns one cell holding its value for
+// the latest day; SignalRules built against this object point at those cells, so a rule is
+// decided straight from them (see Strategy::describeLiveRule). Values follow the same
+// definitions as IndicatorEngine: partial windows average the days available.
+//
+// Rolling sums round differently from the backtest's averages, so every cell also carries
+// a bound on its distance from the reference average (simple: oldest-to-newest sum, as
+// IndicatorEngine's tables; weighted: WeightedTrendFollowingStrategy's per-call formula).
+// A caller whose comparison falls within the bounds settles the cells, replacing them by
+// the reference value for the day, and then decides exactly like a backtest.
+class LiveIndicators
+{
+private:
+    struct RollingAverage
+    {
+        int window;
+        bool weighted;
+        int refreshInterval; // ticks between exact recomputations, bounding rounding drift
+        int sinceRefresh;
+        double leavingWeight; // weight of the price dropping out of a full weighted window
+        double sum;
+        double totalWeight;
+        double value;
+        double tolerance; // bound on |value - reference average|, 0 once settled
+    };
+
+    PriceRing prices;
+    deque<RollingAverage> averages; // deque: cells never move as averages are added
+    unordered_map<int, RollingAverage *> simpleAverages;
+    unordered_map<int, RollingAverage *> weightedAverages;
+    unordered_map<const double *, RollingAverage *> cells; // by address of value
+    double largestPrice; // largest magnitude seen, scaling every bound
+
+    const double *registerAverage(int window, bool weighted);
+    void recompute(RollingAverage &average, long long day);
+    void update(RollingAverage &average, long long day);
+    void finishDay(RollingAverage &average);
+
+public:
+    LiveIndicators();
+
+    // Cell holding the latest day's average over window days, registering the window on
+    // first use. nullptr for non-positive windows, and for windows registered after the
+    // ring has already dropped the prices they need (reported on cerr).
+    const double *simpleAverage(int window);
+    const double *weightedAverage(int window);
+
+    // Cell holding the bound on |*cell - reference average| for the latest day, for a cell
+    // returned by simpleAverage() or weightedAverage(); nullptr for any other pointer
+    const double *toleranceOf(const double *cell) const;
+
+    // Replaces the latest day's value of a cell by the reference average, in O(window).
+    // Meant for the rare days a comparison falls within the bounds.
+    void settle(const double *cell);
+
+    // Appends the next day's price and updates every registered average
+    void append(double price);
+
+    const PriceRing &getPrices() const;
+    long long getDayCount() const;
+    int getAverageCount() const;
+};
+
+#endif // LIVE_INDICATORS_H
@@ -0,0 +1,144 @@
+#include "LiveSession.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include "TradingBot.h"
+
+LiveSession::LiveSession()
+: latencyTracking(true), lastPrice(0.0){
+}
+
+LiveSession::LiveSession(const TradingBot &bot)
+: latencyTracking(true), lastPrice(0.0){
+    for (int i = 0; i < bot.getStrategyCount(); i++) {
+        addStrategy(bot.getStrategy(i));
+    }
+}
+
+int LiveSession::addStrategy(const Strategy *strategy)
+{
+    if (strategy == nullptr) {
+        return -1;
+    }
+    SignalRule rule;
+    bool described = strategy->describeLiveRule(indicators, rule);
+    if (!described) {
+        cerr << "Strategy " << strategy->getName() << " has no live rule and will only HOLD" << endl;
+    }
+    RuleBounds bound;
+    bound.fast = indicators.toleranceOf(rule.fast);
+    bound.slow = indicators.toleranceOf(rule.slow);
+    bound.average = indicators.toleranceOf(rule.average);
+    strategies.push_back(strategy);
+    rules.push_back(rule);
+    bounds.push_back(bound);
+    live.push_back(described ? 1 : 0);
+    positions.push_back(PositionTracker());
+    actions.push_back(HOLD);
+    latencies.push_back(LatencyHistogram());
+    return static_cast<int>(strategies.size()) - 1;
+}
+
+void LiveSession::setLatencyTracking(bool enabled)
+{
+    latencyTracking = enabled;
+}
+
+bool LiveSession::getLatencyTracking() const
+{
+    return latencyTracking;
+}
+
+const vector<Action> &LiveSession::onTick(double price)
+{
+    chrono::steady_clock::time_point arrival;
+    if (latencyTracking) {
+        arrival = chrono::steady_clock::now();
+    }
+    indicators.append(price);
+    lastPrice = price;
+
+    // Live rules point at single cells, so each is decided as day 0 of a one-day span
+    int count = static_cast<int>(strategies.size());
+    for (int slot = 0; slot < count; slot++) {
+        Action action = HOLD;
+        if (live[slot]) {
+            const SignalRule &rule = rules[slot];
+            double holding = positions[slot].getHolding();
+            settleNearTie(rule, bounds[slot]);
+            if (rule.kind == SignalRule::BAND) {
+                action = MeanReversionKernel(rule.average, 0, rule.lowerFactor, rule.upperFactor).decideDay(&lastPrice, 0, holding);
+            } else {
+                action = TrendFollowingKernel(rule.fast, rule.slow, 0).decideDay(&lastPrice, 0, holding);
+            }
+        }
+        positions[slot].apply(action, price);
+        actions[slot] = action;
+        if (latencyTracking) {
+            chrono::nanoseconds elapsed = chrono::steady_clock::now() - arrival;
+            latencies[slot].record(static_cast<uint64_t>(elapsed.count()));
+        }
+    }
+    return actions;
+}
+
+// Settles the rule's cells when its comparison is within their bounds. For a band, the
+// backtest compares the price with the exact average times a factor; both products round
+// once more, hence the extra eps.
+void LiveSession::settleNearTie(const SignalRule &rule, const RuleBounds &bound)
+{
+    if (rule.kind == SignalRule::BAND) {
+        double average = *rule.average;
+        double slack = *bound.average + 4.0 * numeric_limits<double>::epsilon() * fabs(average);
+        bool nearLower = !(fabs(lastPrice - average * rule.lowerFactor) > slack * fabs(rule.lowerFactor));
+        bool nearUpper = !(fabs(lastPrice - average * rule.upperFactor) > slack * fabs(rule.upperFactor));
+        if (nearLower || nearUpper) {
+            indicators.settle(rule.average);
+        }
+    } else if (!(fabs(*rule.fast - *rule.slow) > *bound.fast + *bound.slow)) {
+        indicators.settle(rule.fast);
+        indicators.settle(rule.slow);
+    }
+}
+
+int LiveSession::getStrategyCount() const
+{
+    return static_cast<int>(strategies.size());
+}
+
+const Strategy *LiveSession::getStrategy(int slot) const
+{
+    return strategies[slot];
+}
+
+bool LiveSession::isLive(int slot) const
+{
+    return live[slot] != 0;
+}
+
+long long LiveSession::getTickCount() const
+{
+    return indicators.getDayCount();
+}
+
+Action LiveSession::getAction(int slot) const
+{
+    return actions[slot];
+}
+
+double LiveSession::getHolding(int slot) const
+{
+    return positions[slot].getHolding();
+}
+
+StrategyStats LiveSession::getStats(int slot) const
+{
+    PositionTracker snapshot = positions[slot];
+    return snapshot.finish(lastPrice);
+}
+
+const LatencyHistogram &LiveSession::getLatency(int slot) const
+{
+    return latencies[slot];
+}
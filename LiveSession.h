@@ -0,0 +1,72 @@
+#ifndef LIVE_SESSION_H
+#define LIVE_SESSION_H
+
+#include <vector>
+#include "LatencyHistogram.h"
+#include "LiveIndicators.h"
+#include "Strategy.h"
+#include "StrategyKernels.h"
+
+using namespace std;
+
+class TradingBot;
+
+// Runs strategies on a live feed, one price at a time. Every tick appends the price to a
+// ring buffer, steps the registered moving averages in O(1) and decides each strategy from
+// its live SignalRule, so the work per tick does not grow with the history. Positions and
+// P&L follow the same bookkeeping as a backtest. Optionally records, per strategy, the time
+// from the tick's arrival to that strategy's decision. Comparisons too close to call from
+// the rolling averages are settled with the backtest's exact ones, so replaying a market
+// trades exactly like backtesting it.
+class LiveSession
+{
+private:
+    // Error bounds of a live rule's cells (see LiveIndicators::toleranceOf)
+    struct RuleBounds
+    {
+        const double *fast;
+        const double *slow;
+        const double *average;
+    };
+
+    LiveIndicators indicators;
+    vector<const Strategy *> strategies;
+    vector<SignalRule> rules;
+    vector<RuleBounds> bounds;
+    vector<char> live; // strategy has a live rule; the others always HOLD
+    vector<PositionTracker> positions;
+    vector<Action> actions;
+    vector<LatencyHistogram> latencies;
+    bool latencyTracking;
+    double lastPrice;
+
+    void settleNearTie(const SignalRule &rule, const RuleBounds &bound);
+
+public:
+    LiveSession();
+    // Registers every strategy of the bot, in its order; the bot keeps owning them
+    explicit LiveSession(const TradingBot &bot);
+
+    // Adds a strategy (not owned) that starts flat on the next tick and returns its slot.
+    // Strategies without a live rule are reported on cerr and only ever HOLD.
+    int addStrategy(const Strategy *strategy);
+
+    // Ticks carry a timestamp per strategy when on (the default); off saves the clock reads
+    void setLatencyTracking(bool enabled);
+    bool getLatencyTracking() const;
+
+    // Appends the next price and returns every strategy's action for it, by slot
+    const vector<Action> &onTick(double price);
+
+    int getStrategyCount() const;
+    const Strategy *getStrategy(int slot) const;
+    bool isLive(int slot) const;
+    long long getTickCount() const;
+    Action getAction(int slot) const;
+    double getHolding(int slot) const;
+    // Stats so far, with any open position marked at the last price
+    StrategyStats getStats(int slot) const;
+    const LatencyHistogram &getLatency(int slot) const;
+};
+
+#endif // LIVE_SESSION_H
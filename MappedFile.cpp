@@ -0,0 +1,75 @@
+#include "MappedFile.h"
+#include <fstream>
+
+#ifdef _WIN32
+// Windows builds read the file into memory instead of mapping it
+#else
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close
+#endif
+
+MappedFile::MappedFile(const string &path)
+: contents(nullptr), length(0){
+#ifdef _WIN32
+    ifstream inFile(path, ios::binary | ios::ate);
+    if (!inFile) {
+        return;
+    }
+    streamoff fileSize = inFile.tellg();
+    if (fileSize <= 0) {
+        return;
+    }
+    buffer.resize(static_cast<size_t>(fileSize));
+    inFile.seekg(0);
+    if (!inFile.read(&buffer[0], fileSize)) {
+        buffer.clear();
+        return;
+    }
+    contents = &buffer[0];
+    length = buffer.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void *mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            contents = static_cast<const char *>(mapped);
+            length = static_cast<size_t>(info.st_size);
+        }
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (contents != nullptr) {
+        munmap(const_cast<char *>(contents), length);
+    }
+#endif
+    contents = nullptr;
+    length = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+    return contents != nullptr;
+}
+
+const char *MappedFile::data() const
+{
+    return contents;
+}
+
+size_t MappedFile::size() const
+{
+    return length;
+}
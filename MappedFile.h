@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped, so pages are
+// loaded on demand and nothing is copied; elsewhere it falls back to reading the file into
+// memory. The contents stay valid for the lifetime of the object.
+class MappedFile
+{
+private:
+    const char *contents;
+    size_t length;
+    vector<char> buffer; // used only by the read-into-memory fallback
+
+public:
+    explicit MappedFile(const string &path);
+    ~MappedFile();
+
+    bool isOpen() const;
+    const char *data() const;
+    size_t size() const;
+
+    // Prevent copying
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+};
+
+#endif // MAPPED_FILE_H
@@ -1,51 +1,81 @@
 #include "Market.h"
+#include "GbmKernel.h"
+#include "Instrumentation.h"
+#include "MarketTextParser.h"
 #include "Utils.h"
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// On-disk header of binary market files (version 1). Fields use the writer's native byte
+// order; byteOrderMark lets a reader on the other byte order reject the file.
+struct BinaryMarketHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    double initialPrice;
+    double volatility;
+    double expectedYearlyReturn;
+    int64_t numTradingDays;
+    int64_t seed;
+    uint64_t dataOffset;
+};
+
+static const char BINARY_MARKET_MAGIC[8] = {'T', 'B', 'M', 'A', 'R', 'K', 'E', 'T'};
+static const uint32_t BINARY_MARKET_VERSION = 1;
+static const uint32_t BINARY_BYTE_ORDER_MARK = 0x01020304;
+static const uint64_t BINARY_DATA_ALIGNMENT = 64;
 
 Market::Market(double initialPrice, double volatility, double expectedYearlyReturn, int numTradingDays, int seed)
-: initialPrice(initialPrice), volatility(volatility), expectedYearlyReturn(expectedYearlyReturn), numTradingDays(numTradingDays),  prices(new double*[numTradingDays]),seed(seed)
+: initialPrice(initialPrice), volatility(volatility), expectedYearlyReturn(expectedYearlyReturn), numTradingDays(numTradingDays),  prices(numTradingDays),seed(seed)
 {
-    for(int i = 0; i < numTradingDays; i++)
-    {
-        prices[i] = new double(0.0);
-    }
+    useOwnedPrices();
 }
 
 Market::Market(const string &filename)
 {
     string filePath = "data/" + filename;
-    ifstream inFile(filePath);
-    if (!inFile)
+    MarketTextHeader header;
+    PriceSeries loaded;
+    MarketTextParser parser(filePath);
+    if (!parser.parse(header, loaded, true))
     {
-        cerr << "Error opening file for reading: " << filePath << endl;
         return;
     }
 
-    inFile >> initialPrice >> volatility >> expectedYearlyReturn >> numTradingDays >> seed;
+    initialPrice = header.initialPrice;
+    volatility = header.volatility;
+    expectedYearlyReturn = header.expectedYearlyReturn;
+    numTradingDays = header.numTradingDays;
+    seed = header.seed;
 
-    prices = new double*[numTradingDays];
-    for (int i = 0; i < numTradingDays; i++)
+    // Days missing from the file stay at 0.0
+    prices.resize(numTradingDays);
+    for (int i = 0; i < loaded.size(); i++)
     {
-        prices[i] = new double(0.0);
+        prices[i] = loaded[i];
     }
+    useOwnedPrices();
+}
 
-    double price;
-    int i = 0;
-    while (inFile >> price && i < numTradingDays)
-    {
-        *prices[i++] = price;
-    }
+Market::~Market()
+{
+    releasePriceRefs();
+}
 
-    inFile.close();
+void Market::releasePriceRefs()
+{
+    delete [] priceRefs;
+    priceRefs = nullptr;
 }
 
-Market::~Market()
+void Market::useOwnedPrices()
 {
-    for(int i =0;i<numTradingDays;i++){
-        delete prices[i];
-        prices[i] =nullptr;
-    }
-    delete [] prices;
-    prices = nullptr;
+    releasePriceRefs();
+    mapping.reset();
+    priceView = prices.view();
 }
 
 // ===== Don't modify below this line =====
@@ -61,12 +91,37 @@ double Market::generateZ(int seed)
 
 void Market::simulate() 
 {
-    *prices[0] = roundToDecimals(initialPrice,3);
-    double deltaT= 1.0/TRADING_DAYS_PER_YEAR;
-    for(int i = 1; i < numTradingDays; i++){
-        double Z =generateZ(seed);
-        *prices[i] =  roundToDecimals(*prices[i-1]*exp((expectedYearlyReturn-0.5*(volatility*volatility))*deltaT+ (volatility*sqrt(deltaT)*Z)),3);
+    INSTRUMENT_SCOPE("Market::simulate");
+    // A mapped file is read-only; simulate into owned storage instead
+    if (mapping) {
+        prices.resize(numTradingDays);
+        useOwnedPrices();
+    }
+
+    if (prices.empty()) {
+        return;
+    }
+    INSTRUMENT_ITEMS("days", prices.size());
+
+    // Draw all normals up front, in day order, straight into the slots they will price
+    for(int i = 1; i < prices.size(); i++){
+        prices[i] = generateZ(seed);
     }
+
+    double deltaT= 1.0/TRADING_DAYS_PER_YEAR;
+    double drift = (expectedYearlyReturn-0.5*(volatility*volatility))*deltaT;
+    double diffusion = volatility*sqrt(deltaT);
+    GbmKernel::simulatePath(initialPrice, drift, diffusion, prices.data() + 1, prices.size(), exactRounding, prices.data());
+}
+
+void Market::setExactRounding(bool exact)
+{
+    exactRounding = exact;
+}
+
+bool Market::getExactRounding() const
+{
+    return exactRounding;
 }
 
 double Market::getVolatility() const
@@ -81,26 +136,34 @@ double Market::getExpectedYearlyReturn() const
 
 double **Market::getPrices() const
 {
-    return prices;
+    if (priceRefs == nullptr && !priceView.empty()) {
+        priceRefs = new double*[priceView.size()];
+        double *first = const_cast<double *>(priceView.data());
+        for (int i = 0; i < priceView.size(); i++) {
+            priceRefs[i] = first + i;
+        }
+    }
+    return priceRefs;
+}
+
+PriceView Market::getPriceView() const
+{
+    return priceView;
 }
 
 double Market::getPrice(int index) const
 {
-    if (index < 0 || index >= numTradingDays || prices == nullptr) {
-        return 0.0;
-    }
-    
-    if (prices[index] == nullptr) {
+    if (index < 0 || index >= numTradingDays || index >= priceView.size()) {
         return 0.0;
     }
-    
-    return *prices[index];
+
+    return priceView[index];
 }
 
 double Market::getLastPrice() const
 {
     // Add safety check
-    if (numTradingDays <= 0 || prices == nullptr) {
+    if (numTradingDays <= 0 || priceView.empty()) {
         cerr << "Warning: Attempted to access last price of empty market" << endl;
         return 0.0;
     }
@@ -142,7 +205,7 @@ void Market::writeToFile(const string &filename)
 
     for (int i = 0; i < numTradingDays; ++i)
     {
-        outFile << *prices[i] << endl;
+        outFile << getPrice(i) << endl;
     }
 
     outFile.close();
@@ -151,58 +214,172 @@ void Market::writeToFile(const string &filename)
 
 void Market::loadFromFile(const string &filename)
 {
+    INSTRUMENT_SCOPE("Market::loadFromFile");
     string filePath = "data/" + filename;
-    ifstream inFile(filePath);
-    if (!inFile)
+
+    // Single buffered pass; storage grows as prices are read, so no separate counting pass
+    MarketTextHeader header;
+    PriceSeries loaded;
+    MarketTextParser parser(filePath);
+    if (!parser.parse(header, loaded))
     {
-        cerr << "Error opening file for reading: " << filePath << endl;
         return;
     }
 
-    inFile >> initialPrice >> volatility >> expectedYearlyReturn >> numTradingDays >> seed;
+    initialPrice = header.initialPrice;
+    volatility = header.volatility;
+    expectedYearlyReturn = header.expectedYearlyReturn;
+    numTradingDays = header.numTradingDays;
+    seed = header.seed;
+
+    prices.swap(loaded);
+    useOwnedPrices();
+    int pricesSize = prices.size();
+    INSTRUMENT_ITEMS("days", pricesSize);
 
-    // Clear existing prices
-    if (prices)
+    cout << "Loaded parameters from file: " << filePath << endl;
+    cout << "Initial Price: " << initialPrice << ", Volatility: " << volatility
+         << ", Expected Yearly Return: " << expectedYearlyReturn
+         << ", Num of Trading Days: " << numTradingDays << ", Seed: " << seed << endl;
+    cout << "Loaded " << pricesSize << " price entries." << endl;
+}
+// ===== Don't modify above this line =====
+
+// TODO: Implement the member functions of the Market class
+
+void Market::assignPrices(PriceView source)
+{
+    prices.resize(source.size());
+    for (int i = 0; i < source.size(); i++)
     {
-        for (int i = 0; i < numTradingDays; i++)
-        {
-            delete prices[i];
-        }
-        delete[] prices;
-    }
-
-    // Count number of prices first
-    ifstream countFile(filePath);
-    string line;
-    int count = 0;
-    double dummy;
-    countFile >> dummy >> dummy >> dummy >> dummy >> dummy; // Skip parameters
-    while (countFile >> dummy)
-        count++;
-    countFile.close();
-
-    // Allocate new array
-    prices = new double *[count];
-    for (int i = 0; i < count; i++)
+        prices[i] = source[i];
+    }
+    numTradingDays = source.size();
+    useOwnedPrices();
+}
+
+bool Market::isMapped() const
+{
+    return mapping != nullptr;
+}
+
+void Market::writeBinary(const string &filename)
+{
+    string folder = "data";
+    string filePath = folder + "/" + filename;
+
+    createDirectory(folder);
+
+    // The prices may be mapped from filePath itself, so truncating it in place would destroy
+    // them mid-write. Write a sibling file and rename it over the target once it is complete.
+    string tempPath = filePath + ".tmp";
+    ofstream outFile(tempPath, ios::binary);
+    if (!outFile)
     {
-        prices[i] = new double(0.0);
+        cerr << "Error opening file for writing: " << tempPath << endl;
+        return;
+    }
+
+    int days = max(numTradingDays, 0);
+    BinaryMarketHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MARKET_MAGIC, sizeof(header.magic));
+    header.version = BINARY_MARKET_VERSION;
+    header.byteOrderMark = BINARY_BYTE_ORDER_MARK;
+    header.initialPrice = initialPrice;
+    header.volatility = volatility;
+    header.expectedYearlyReturn = expectedYearlyReturn;
+    header.numTradingDays = days;
+    header.seed = seed;
+    header.dataOffset = (sizeof(header) + BINARY_DATA_ALIGNMENT - 1) / BINARY_DATA_ALIGNMENT * BINARY_DATA_ALIGNMENT;
+
+    outFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (uint64_t pad = sizeof(header); pad < header.dataOffset; pad++) {
+        outFile.put('\0');
+    }
+
+    // Stored prices go out as one block; days past the end of storage read as 0.0, as in getPrice()
+    int stored = min(days, priceView.size());
+    outFile.write(reinterpret_cast<const char *>(priceView.data()), static_cast<streamsize>(stored) * sizeof(double));
+    double zero = 0.0;
+    for (int i = stored; i < days; i++) {
+        outFile.write(reinterpret_cast<const char *>(&zero), sizeof(zero));
     }
 
-    // Read prices
-    int pricesSize = 0;
-    double price;
-    while (inFile >> price)
+    outFile.close();
+    if (!outFile)
+    {
+        cerr << "Error writing file: " << tempPath << endl;
+        remove(tempPath.c_str());
+        return;
+    }
+    if (rename(tempPath.c_str(), filePath.c_str()) != 0)
     {
-        *prices[pricesSize++] = price;
+        cerr << "Error replacing file: " << filePath << endl;
+        remove(tempPath.c_str());
+        return;
     }
+    cout << "Market parameters and prices written to binary file: " << filePath << endl;
+}
+
+void Market::loadBinary(const string &filename)
+{
+    INSTRUMENT_SCOPE("Market::loadBinary");
+    string filePath = "data/" + filename;
+    shared_ptr<MappedFile> file(new MappedFile(filePath));
+    if (!file->isOpen())
+    {
+        cerr << "Error opening file for reading: " << filePath << endl;
+        return;
+    }
+
+    BinaryMarketHeader header;
+    if (file->size() < sizeof(header))
+    {
+        cerr << "Invalid binary market file (truncated header): " << filePath << endl;
+        return;
+    }
+    memcpy(&header, file->data(), sizeof(header));
+
+    if (memcmp(header.magic, BINARY_MARKET_MAGIC, sizeof(header.magic)) != 0)
+    {
+        cerr << "Invalid binary market file (bad magic): " << filePath << endl;
+        return;
+    }
+    if (header.byteOrderMark != BINARY_BYTE_ORDER_MARK)
+    {
+        cerr << "Invalid binary market file (written with a different byte order): " << filePath << endl;
+        return;
+    }
+    if (header.version != BINARY_MARKET_VERSION)
+    {
+        cerr << "Unsupported binary market file version " << header.version << ": " << filePath << endl;
+        return;
+    }
+    if (header.numTradingDays < 0 || header.numTradingDays > INT_MAX || header.seed < INT_MIN || header.seed > INT_MAX
+        || header.dataOffset < sizeof(header) || header.dataOffset % sizeof(double) != 0
+        || header.dataOffset > file->size()
+        || static_cast<uint64_t>(header.numTradingDays) > (file->size() - header.dataOffset) / sizeof(double))
+    {
+        cerr << "Invalid binary market file (inconsistent header): " << filePath << endl;
+        return;
+    }
+
+    initialPrice = header.initialPrice;
+    volatility = header.volatility;
+    expectedYearlyReturn = header.expectedYearlyReturn;
+    numTradingDays = static_cast<int>(header.numTradingDays);
+    seed = static_cast<int>(header.seed);
+
+    // Serve prices straight from the mapping; owned storage is no longer needed
+    releasePriceRefs();
+    prices = PriceSeries();
+    mapping = file;
+    priceView = PriceView(reinterpret_cast<const double *>(file->data() + header.dataOffset), numTradingDays);
 
-    inFile.close();
     cout << "Loaded parameters from file: " << filePath << endl;
     cout << "Initial Price: " << initialPrice << ", Volatility: " << volatility
          << ", Expected Yearly Return: " << expectedYearlyReturn
          << ", Num of Trading Days: " << numTradingDays << ", Seed: " << seed << endl;
-    cout << "Loaded " << pricesSize << " price entries." << endl;
+    cout << "Mapped " << priceView.size() << " price entries." << endl;
 }
-// ===== Don't modify above this line =====
-
-// TODO: Implement the member functions of the Market class
@@ -6,6 +6,9 @@
 #include <random>
 #include <fstream>
 #include <filesystem>
+#include <memory>
+#include "PriceSeries.h"
+#include "MappedFile.h"
 
 #ifdef _WIN32
 #include <direct.h> // For mkdir on Windows
@@ -19,16 +22,24 @@ class Market
 {
 
 private:
-    double initialPrice;
-    double volatility;
-    double expectedYearlyReturn;
-    int numTradingDays;
-    double **prices = nullptr;
-    // int pricesSize = 0;
+    double initialPrice = 0.0;
+    double volatility = 0.0;
+    double expectedYearlyReturn = 0.0;
+    int numTradingDays = 0;
+    PriceSeries prices;
+    // Read-only mapping of a binary market file; while set it backs the prices instead
+    shared_ptr<MappedFile> mapping;
+    // Whichever of the two storages currently holds the prices
+    PriceView priceView;
+    // Pointer table handed out by getPrices(); built lazily into the contiguous storage
+    mutable double **priceRefs = nullptr;
     int seed = -1;
+    bool exactRounding = true;
 
     double generateZ(int seed);
     void createDirectory(const string &folder);
+    void releasePriceRefs();
+    void useOwnedPrices();
 
 public:
     Market(double initialPrice, double volatility, double expectedYearlyReturn, int numTradingDays, int seed = -1);
@@ -36,14 +47,38 @@ public:
     ~Market();
 
     void simulate();
+
+    // With exact rounding (the default) simulate() rounds each day before compounding it,
+    // as it always has. Turning it off lets the SIMD kernel compute the whole path from a
+    // log-space prefix sum; prices may then differ in the last decimal. See GbmKernel.
+    void setExactRounding(bool exact);
+    bool getExactRounding() const;
     void writeToFile(const string &filename);
     void loadFromFile(const string &filename);
+
+    // Versioned binary format: a fixed header (parameters, day count, seed) followed by the
+    // raw, 64-byte aligned price array. loadBinary maps the file read-only and serves the
+    // prices straight from the mapping; simulate() switches back to owned storage.
+    void writeBinary(const string &filename);
+    void loadBinary(const string &filename);
+    bool isMapped() const;
+
+    // Replaces the prices with a copy of the given series (for example one path of a
+    // MarketEnsemble); the day count follows its length, the other parameters are kept.
+    void assignPrices(PriceView source);
     double getVolatility() const;
     double getExpectedYearlyReturn() const;
+    // Compatibility shim for callers that still expect one pointer per day; prefer getPriceView().
+    // The pointers of a mapped market refer to read-only memory.
     double **getPrices() const;
+    PriceView getPriceView() const;
     double getPrice(int index) const;
     double getLastPrice() const;
     int getNumTradingDays() const;
+
+    // Prevent copying
+    Market(const Market &) = delete;
+    Market &operator=(const Market &) = delete;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "MarketEnsemble.h"
+#include "CounterRandom.h"
+#include "GbmKernel.h"
+#include "Utils.h"
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+MarketEnsemble::MarketEnsemble(double initialPrice, double volatility, double expectedYearlyReturn, int numTradingDays, int numPaths, long long seed)
+: initialPrice(initialPrice), volatility(volatility), expectedYearlyReturn(expectedYearlyReturn), numTradingDays(numTradingDays > 0 ? numTradingDays : 0),
+  numPaths(numPaths > 0 ? numPaths : 0), seed(0), threadCount(1), exactRounding(true)
+{
+    if (seed == -1) {
+        random_device device;
+        this->seed = (static_cast<uint64_t>(device()) << 32) | device();
+    } else {
+        this->seed = static_cast<uint64_t>(seed);
+    }
+
+    if (this->numTradingDays > 0 && this->numPaths > INT_MAX / this->numTradingDays) {
+        cerr << "Market ensemble too large: " << numPaths << " paths of " << numTradingDays << " days" << endl;
+        this->numPaths = 0;
+    }
+}
+
+void MarketEnsemble::setThreadCount(int threads)
+{
+    int resolved = threads > 0 ? threads : WorkStealingPool::defaultThreadCount();
+    if (resolved != threadCount) {
+        pool.reset();
+    }
+    threadCount = resolved;
+}
+
+int MarketEnsemble::getThreadCount() const
+{
+    return threadCount;
+}
+
+void MarketEnsemble::setExactRounding(bool exact)
+{
+    exactRounding = exact;
+}
+
+bool MarketEnsemble::getExactRounding() const
+{
+    return exactRounding;
+}
+
+void MarketEnsemble::generatePath(int path, double *pathPrices) const
+{
+    if (numTradingDays == 0) {
+        return;
+    }
+
+    double deltaT = 1.0 / TRADING_DAYS_PER_YEAR;
+    double drift = (expectedYearlyReturn - 0.5 * (volatility * volatility)) * deltaT;
+    double diffusion = volatility * sqrt(deltaT);
+
+    // Day i uses draw i-1; each Philox block yields the draws for two consecutive days.
+    // The draws are written into the slots they will price, which the kernel allows.
+    Philox4x32 random(seed);
+    uint32_t counter[4] = {0, 0, static_cast<uint32_t>(path), 0};
+    for (int draw = 0; draw < numTradingDays - 1; draw += 2) {
+        counter[0] = static_cast<uint32_t>(draw / 2);
+        double first, second;
+        random.normalPair(counter, first, second);
+        pathPrices[draw + 1] = first;
+        if (draw + 2 < numTradingDays) {
+            pathPrices[draw + 2] = second;
+        }
+    }
+
+    GbmKernel::simulatePath(initialPrice, drift, diffusion, pathPrices + 1, numTradingDays, exactRounding, pathPrices);
+}
+
+void MarketEnsemble::simulate()
+{
+    if (prices.size() != numPaths * numTradingDays) {
+        prices.resize(numPaths * numTradingDays);
+    }
+    double *allPrices = prices.data();
+    if (threadCount > 1 && numPaths > 1) {
+        if (!pool) {
+            pool.reset(new WorkStealingPool(threadCount));
+        }
+        pool->parallelFor(numPaths, [this, allPrices](int path) {
+            generatePath(path, allPrices + static_cast<size_t>(path) * numTradingDays);
+        });
+    } else {
+        for (int path = 0; path < numPaths; path++) {
+            generatePath(path, allPrices + static_cast<size_t>(path) * numTradingDays);
+        }
+    }
+}
+
+int MarketEnsemble::getNumPaths() const
+{
+    return numPaths;
+}
+
+int MarketEnsemble::getNumTradingDays() const
+{
+    return numTradingDays;
+}
+
+uint64_t MarketEnsemble::getSeed() const
+{
+    return seed;
+}
+
+PriceView MarketEnsemble::getPath(int path) const
+{
+    if (path < 0 || path >= numPaths || prices.empty()) {
+        return PriceView();
+    }
+    return prices.view().subview(path * numTradingDays, numTradingDays);
+}
+
+double MarketEnsemble::getPrice(int path, int day) const
+{
+    if (path < 0 || path >= numPaths || day < 0 || day >= numTradingDays || prices.empty()) {
+        return 0.0;
+    }
+    return prices[path * numTradingDays + day];
+}
+
+PriceView MarketEnsemble::getAllPrices() const
+{
+    return prices.view();
+}
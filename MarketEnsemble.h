@@ -0,0 +1,65 @@
+#ifndef MARKET_ENSEMBLE_H
+#define MARKET_ENSEMBLE_H
+
+#include <cstdint>
+#include <memory>
+#include "PriceSeries.h"
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+// Many independent GBM price paths sharing one set of market parameters. Prices are stored
+// contiguously as [path][day]. Every normal draw comes from a Philox stream addressed by
+// (seed, path, day), so a path's prices depend only on the seed and its index: the result
+// is identical for any thread count and for any number of paths generated alongside it.
+class MarketEnsemble
+{
+private:
+    double initialPrice;
+    double volatility;
+    double expectedYearlyReturn;
+    int numTradingDays;
+    int numPaths;
+    uint64_t seed;
+    PriceSeries prices;
+    int threadCount;
+    bool exactRounding;
+    unique_ptr<WorkStealingPool> pool;
+
+
+public:
+    // seed == -1 draws a seed from random_device; getSeed() reports it for reproduction
+    MarketEnsemble(double initialPrice, double volatility, double expectedYearlyReturn, int numTradingDays, int numPaths, long long seed = -1);
+
+    // Number of threads simulate() spreads paths over: 1 (the default) runs serially,
+    // 0 uses every hardware thread. The generated prices do not depend on this setting.
+    void setThreadCount(int threads);
+    int getThreadCount() const;
+
+    // Same switch as Market::setExactRounding; on by default
+    void setExactRounding(bool exact);
+    bool getExactRounding() const;
+
+    // Generates every path with the same formula and rounding as Market::simulate. The
+    // [path][day] storage is allocated on the first call.
+    void simulate();
+
+    // Writes one path's getNumTradingDays() prices to out without storing them: the same
+    // values getPath(path) holds after simulate(). Safe to call from several threads.
+    void generatePath(int path, double *out) const;
+
+    int getNumPaths() const;
+    int getNumTradingDays() const;
+    uint64_t getSeed() const;
+
+    PriceView getPath(int path) const;
+    double getPrice(int path, int day) const;
+    // All paths back to back, path-major
+    PriceView getAllPrices() const;
+
+    // Prevent copying
+    MarketEnsemble(const MarketEnsemble &) = delete;
+    MarketEnsemble &operator=(const MarketEnsemble &) = delete;
+};
+
+#endif // MARKET_ENSEMBLE_H
@@ -0,0 +1,318 @@
+#include "MarketTextParser.h"
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+// Powers of ten that are exact in a double; a significand below 2^53 scaled by one of these
+// is a single correctly rounded operation, which is what makes the fast path exact.
+static const double EXACT_POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const uint64_t MAX_EXACT_SIGNIFICAND = 1ULL << 53;
+static const int MAX_REPORTED_LINES = 10;
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+MarketTextParser::MarketTextParser(const string &path)
+: path(path), malformedLines(0){
+}
+
+int MarketTextParser::getMalformedLines() const
+{
+    return malformedLines;
+}
+
+bool MarketTextParser::parseDouble(const char *first, const char *last, double &value)
+{
+    const char *p = first;
+    bool negative = false;
+    if (p < last && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t significand = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+    bool anyDigits = false;
+    bool exact = true;
+
+    for (; p < last && isDigit(*p); p++) {
+        anyDigits = true;
+        if (significantDigits < 19) {
+            significand = significand * 10 + (*p - '0');
+            significantDigits += significand != 0 ? 1 : 0;
+        } else {
+            // Dropped integer digits still scale the value
+            exponent++;
+            exact = false;
+        }
+    }
+    if (p < last && *p == '.') {
+        p++;
+        for (; p < last && isDigit(*p); p++) {
+            anyDigits = true;
+            if (significantDigits < 19) {
+                significand = significand * 10 + (*p - '0');
+                significantDigits += significand != 0 ? 1 : 0;
+                exponent--;
+            } else {
+                exact = false;
+            }
+        }
+    }
+    if (!anyDigits) {
+        return false;
+    }
+
+    if (p < last && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < last && (*p == '+' || *p == '-')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        if (p == last || !isDigit(*p)) {
+            return false;
+        }
+        int written = 0;
+        for (; p < last && isDigit(*p); p++) {
+            if (written < 100000) {
+                written = written * 10 + (*p - '0');
+            }
+        }
+        exponent += negativeExponent ? -written : written;
+    }
+    if (p != last) {
+        return false;
+    }
+
+    if (significand == 0 && exact) {
+        value = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (exact && significand <= MAX_EXACT_SIGNIFICAND && exponent >= -22 && exponent <= 22) {
+        double magnitude = static_cast<double>(significand);
+        magnitude = exponent < 0 ? magnitude / EXACT_POWERS_OF_TEN[-exponent] : magnitude * EXACT_POWERS_OF_TEN[exponent];
+        value = negative ? -magnitude : magnitude;
+        return true;
+    }
+
+    // Too many digits or too large an exponent for the exact shortcut. The token's syntax is
+    // already checked, so from_chars converts it correctly rounded without copying it.
+    const char *digits = first;
+    if (*digits == '+') {
+        digits++;
+    }
+    double parsed = 0.0;
+    from_chars_result result = from_chars(digits, last, parsed);
+    if (result.ec == errc::result_out_of_range) {
+        // significand * 10^exponent approximates the token with significand >= 1, so a
+        // positive exponent means it overflowed and anything else means it underflowed
+        parsed = exponent > 0 ? numeric_limits<double>::infinity() : 0.0;
+        parsed = negative ? -parsed : parsed;
+    } else if (result.ec != errc() || result.ptr != last) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool MarketTextParser::parseInt(const char *first, const char *last, int &value)
+{
+    const char *p = first;
+    bool negative = false;
+    if (p < last && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == last) {
+        return false;
+    }
+
+    long long magnitude = 0;
+    for (; p < last; p++) {
+        if (!isDigit(*p)) {
+            return false;
+        }
+        magnitude = magnitude * 10 + (*p - '0');
+        if (magnitude > static_cast<long long>(INT_MAX) + 1) {
+            return false;
+        }
+    }
+    long long result = negative ? -magnitude : magnitude;
+    if (result > INT_MAX || result < INT_MIN) {
+        return false;
+    }
+    value = static_cast<int>(result);
+    return true;
+}
+
+bool MarketTextParser::parseHeader(const char *first, const char *last, MarketTextHeader &header) const
+{
+    const char *fields[5][2];
+    int numFields = 0;
+    const char *p = first;
+    while (p < last) {
+        while (p < last && isBlank(*p)) {
+            p++;
+        }
+        if (p == last) {
+            break;
+        }
+        const char *tokenStart = p;
+        while (p < last && !isBlank(*p)) {
+            p++;
+        }
+        if (numFields == 5) {
+            return false;
+        }
+        fields[numFields][0] = tokenStart;
+        fields[numFields][1] = p;
+        numFields++;
+    }
+
+    return numFields == 5
+        && parseDouble(fields[0][0], fields[0][1], header.initialPrice)
+        && parseDouble(fields[1][0], fields[1][1], header.volatility)
+        && parseDouble(fields[2][0], fields[2][1], header.expectedYearlyReturn)
+        && parseInt(fields[3][0], fields[3][1], header.numTradingDays)
+        && parseInt(fields[4][0], fields[4][1], header.seed);
+}
+
+void MarketTextParser::reportMalformed(long long lineNumber, const char *first, const char *last)
+{
+    malformedLines++;
+    if (malformedLines <= MAX_REPORTED_LINES) {
+        cerr << "Malformed price on line " << lineNumber << " of " << path << ": '" << string(first, last) << "'" << endl;
+    }
+}
+
+bool MarketTextParser::parse(MarketTextHeader &header, PriceSeries &prices, bool stopAtHeaderCount)
+{
+    malformedLines = 0;
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        cerr << "Error opening file for reading: " << path << endl;
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long long fileSize = max(ftell(file), 0L);
+    rewind(file);
+
+    MarketTextHeader parsedHeader;
+    bool haveHeader = false;
+    bool done = false;
+    PriceSeries values;
+    int count = 0;
+    int maxPrices = -1;
+    long long lineNumber = 0;
+
+    // A line cut off at the end of a chunk is moved to the front of the buffer and completed
+    // by the next read; the buffer doubles if a single line ever outgrows it.
+    vector<char> buffer(CHUNK_SIZE);
+    size_t carried = 0;
+    bool endOfFile = false;
+    while (!done && !endOfFile) {
+        if (carried == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        size_t got = fread(&buffer[carried], 1, buffer.size() - carried, file);
+        endOfFile = got < buffer.size() - carried;
+        const char *cursor = &buffer[0];
+        const char *end = cursor + carried + got;
+
+        while (!done && cursor < end) {
+            const char *newline = static_cast<const char *>(memchr(cursor, '\n', end - cursor));
+            if (newline == nullptr) {
+                if (!endOfFile) {
+                    break;
+                }
+                newline = end;
+            }
+
+            const char *first = cursor;
+            const char *last = newline;
+            cursor = newline < end ? newline + 1 : end;
+            lineNumber++;
+
+            while (first < last && isBlank(*first)) {
+                first++;
+            }
+            while (last > first && isBlank(last[-1])) {
+                last--;
+            }
+            if (first == last) {
+                continue;
+            }
+
+            if (!haveHeader) {
+                if (!parseHeader(first, last, parsedHeader)) {
+                    cerr << "Malformed header on line " << lineNumber << " of " << path << endl;
+                    fclose(file);
+                    return false;
+                }
+                haveHeader = true;
+                // Unless asked to stop there, the header's day count is only a capacity hint
+                // and is capped by what the file could hold (a price line takes at least two bytes),
+                // so a corrupt header cannot force a huge allocation; the doubling below handles the rest.
+                int expected = max(parsedHeader.numTradingDays, 0);
+                maxPrices = stopAtHeaderCount ? expected : -1;
+                values.resize(static_cast<int>(min<long long>(expected, fileSize / 2)));
+                done = maxPrices == 0;
+                continue;
+            }
+
+            double price;
+            if (!parseDouble(first, last, price)) {
+                reportMalformed(lineNumber, first, last);
+                continue;
+            }
+            if (count == values.size()) {
+                PriceSeries larger(max(1024, values.size() * 2));
+                if (count > 0) {
+                    memcpy(larger.data(), values.data(), sizeof(double) * count);
+                }
+                values.swap(larger);
+            }
+            values[count++] = price;
+            done = maxPrices >= 0 && count >= maxPrices;
+        }
+
+        carried = end - cursor;
+        if (carried > 0) {
+            memmove(&buffer[0], cursor, carried);
+        }
+    }
+    fclose(file);
+
+    if (!haveHeader) {
+        cerr << "Missing header in " << path << endl;
+        return false;
+    }
+    if (malformedLines > MAX_REPORTED_LINES) {
+        cerr << "... " << (malformedLines - MAX_REPORTED_LINES) << " more malformed lines in " << path << endl;
+    }
+
+    values.truncate(count);
+    prices.swap(values);
+    header = parsedHeader;
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef MARKET_TEXT_PARSER_H
+#define MARKET_TEXT_PARSER_H
+
+#include <string>
+#include "PriceSeries.h"
+
+using namespace std;
+
+// Parameters stored on the first line of a text market file
+struct MarketTextHeader
+{
+    double initialPrice;
+    double volatility;
+    double expectedYearlyReturn;
+    int numTradingDays;
+    int seed;
+
+    MarketTextHeader() : initialPrice(0.0), volatility(0.0), expectedYearlyReturn(0.0), numTradingDays(0), seed(-1) {}
+};
+
+// Single-pass loader for the data/*.txt layout: a header line followed by one price per line.
+// The file is read in large chunks and numbers are converted without iostreams or locales.
+class MarketTextParser
+{
+private:
+    static const size_t CHUNK_SIZE = 1 << 20;
+
+    string path;
+    int malformedLines;
+
+    bool parseHeader(const char *first, const char *last, MarketTextHeader &header) const;
+    void reportMalformed(long long lineNumber, const char *first, const char *last);
+
+public:
+    explicit MarketTextParser(const string &path);
+
+    // Reads the header and every price (or only as many as the header's day count when
+    // stopAtHeaderCount is set) into prices, which ends up sized to the number actually read.
+    // Malformed price lines are reported on cerr with their line number and skipped. Returns
+    // false, after reporting why, if the file cannot be opened or its header is malformed;
+    // header and prices are then left untouched.
+    bool parse(MarketTextHeader &header, PriceSeries &prices, bool stopAtHeaderCount = false);
+
+    int getMalformedLines() const;
+
+    // Parses one decimal number spanning exactly [first, last). Values whose significand and
+    // exponent fit a double exactly take an exact fast path; the rest go through from_chars.
+    static bool parseDouble(const char *first, const char *last, double &value);
+    static bool parseInt(const char *first, const char *last, int &value);
+};
+
+#endif // MARKET_TEXT_PARSER_H
@@ -0,0 +1,177 @@
+#include "MeanReversionBatch.h"
+#include "StrategyKernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MEAN_REVERSION_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+static const int AVX2_LANES = 4;
+
+MeanReversionBatch::MeanReversionBatch(const double *prices, const double *average, int firstIndex)
+: prices(prices), average(average), firstIndex(firstIndex){
+}
+
+void MeanReversionBatch::addBand(double lowerFactor, double upperFactor)
+{
+    lowerFactors.push_back(lowerFactor);
+    upperFactors.push_back(upperFactor);
+}
+
+int MeanReversionBatch::getBandCount() const
+{
+    return static_cast<int>(lowerFactors.size());
+}
+
+MeanReversionBatch::InstructionSet MeanReversionBatch::bestAvailable()
+{
+#ifdef MEAN_REVERSION_BATCH_X86
+    static const InstructionSet detected = __builtin_cpu_supports("avx2") ? AVX2 : SCALAR;
+    return detected;
+#else
+    return SCALAR;
+#endif
+}
+
+#ifdef MEAN_REVERSION_BATCH_X86
+
+// Four bands in the lanes of each register. Every step is the branch-free form of
+// MeanReversionKernel::decideDay followed by PositionTracker::apply, in the same
+// floating-point operations, so the lanes end with exactly the trackers' values. The
+// position is kept as a lane mask, so it carries over between days through one OR/ANDNOT.
+// std::max(a, b) is (a < b ? b : a), which _mm256_max_pd(b, a) matches NaNs included.
+struct BandLanes
+{
+    __m256d lower, upper;
+    __m256d held, buyPrice, profit, peakEquity, maxDrawdown;
+    __m256i tradeCount, winningTrades, exposureDays; // minus the sum of the all-ones masks
+};
+
+__attribute__((target("avx2"), always_inline))
+static inline void initLanes(BandLanes &lanes, const double *lowerFactors, const double *upperFactors)
+{
+    lanes.lower = _mm256_loadu_pd(lowerFactors);
+    lanes.upper = _mm256_loadu_pd(upperFactors);
+    lanes.held = lanes.buyPrice = lanes.profit = lanes.peakEquity = lanes.maxDrawdown = _mm256_setzero_pd();
+    lanes.tradeCount = lanes.winningTrades = lanes.exposureDays = _mm256_setzero_si256();
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline void stepLanes(BandLanes &lanes, __m256d price, __m256d movingAvg)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d below = _mm256_cmp_pd(price, _mm256_mul_pd(movingAvg, lanes.lower), _CMP_LT_OQ);
+    __m256d above = _mm256_cmp_pd(price, _mm256_mul_pd(movingAvg, lanes.upper), _CMP_GT_OQ);
+    __m256d buy = _mm256_andnot_pd(lanes.held, below);
+    __m256d sell = _mm256_and_pd(lanes.held, above);
+
+    __m256d tradeProfit = _mm256_sub_pd(price, lanes.buyPrice);
+    __m256d won = _mm256_and_pd(sell, _mm256_cmp_pd(tradeProfit, zero, _CMP_GT_OQ));
+    lanes.profit = _mm256_blendv_pd(lanes.profit, _mm256_add_pd(lanes.profit, tradeProfit), sell);
+    lanes.tradeCount = _mm256_sub_epi64(lanes.tradeCount, _mm256_castpd_si256(sell));
+    lanes.winningTrades = _mm256_sub_epi64(lanes.winningTrades, _mm256_castpd_si256(won));
+    lanes.buyPrice = _mm256_blendv_pd(lanes.buyPrice, price, buy);
+    lanes.held = _mm256_or_pd(_mm256_andnot_pd(sell, lanes.held), buy);
+
+    __m256d equity = _mm256_blendv_pd(lanes.profit, _mm256_add_pd(lanes.profit, _mm256_sub_pd(price, lanes.buyPrice)), lanes.held);
+    lanes.exposureDays = _mm256_sub_epi64(lanes.exposureDays, _mm256_castpd_si256(lanes.held));
+    lanes.peakEquity = _mm256_max_pd(equity, lanes.peakEquity);
+    lanes.maxDrawdown = _mm256_max_pd(_mm256_sub_pd(lanes.peakEquity, equity), lanes.maxDrawdown);
+}
+
+// PositionTracker::finish, lane by lane
+__attribute__((target("avx2")))
+static void finishLanes(const BandLanes &lanes, double lastPrice, StrategyStats *results)
+{
+    double buyPrice[AVX2_LANES], profit[AVX2_LANES], maxDrawdown[AVX2_LANES];
+    long long tradeCount[AVX2_LANES], winningTrades[AVX2_LANES], exposureDays[AVX2_LANES];
+    int heldLanes = _mm256_movemask_pd(lanes.held);
+    _mm256_storeu_pd(buyPrice, lanes.buyPrice);
+    _mm256_storeu_pd(profit, lanes.profit);
+    _mm256_storeu_pd(maxDrawdown, lanes.maxDrawdown);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(tradeCount), lanes.tradeCount);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(winningTrades), lanes.winningTrades);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(exposureDays), lanes.exposureDays);
+
+    for (int lane = 0; lane < AVX2_LANES; lane++) {
+        StrategyStats &stats = results[lane];
+        stats.profit = profit[lane];
+        stats.tradeCount = static_cast<int>(tradeCount[lane]);
+        stats.winningTrades = static_cast<int>(winningTrades[lane]);
+        stats.maxDrawdown = maxDrawdown[lane];
+        stats.exposureDays = static_cast<int>(exposureDays[lane]);
+        if (heldLanes & (1 << lane)) {
+            double tradeProfit = lastPrice - buyPrice[lane];
+            stats.profit += tradeProfit;
+            stats.tradeCount++;
+            stats.winningTrades += tradeProfit > 0.0 ? 1 : 0;
+        }
+    }
+}
+
+// Runs one or two registers side by side: the running maxima and blends are latency-bound,
+// so a second independent register fills the first one's pipeline gaps. The lanes are
+// separate locals rather than an array so that their state stays in registers.
+template <int Registers>
+__attribute__((target("avx2")))
+static void runLanesAvx2(const double *prices, const double *average, int firstIndex, const double *lowerFactors,
+                         const double *upperFactors, int startDay, int endDay, StrategyStats *results)
+{
+    BandLanes first, second;
+    initLanes(first, lowerFactors, upperFactors);
+    if (Registers == 2) {
+        initLanes(second, lowerFactors + AVX2_LANES, upperFactors + AVX2_LANES);
+    }
+    for (int day = startDay; day < endDay; day++) {
+        __m256d price = _mm256_set1_pd(prices[day]);
+        __m256d movingAvg = _mm256_set1_pd(average[day - firstIndex]);
+        stepLanes(first, price, movingAvg);
+        if (Registers == 2) {
+            stepLanes(second, price, movingAvg);
+        }
+    }
+    finishLanes(first, prices[endDay - 1], results);
+    if (Registers == 2) {
+        finishLanes(second, prices[endDay - 1], results + AVX2_LANES);
+    }
+}
+
+#endif // MEAN_REVERSION_BATCH_X86
+
+void MeanReversionBatch::run(int startDay, int endDay, vector<StrategyStats> &results) const
+{
+    run(startDay, endDay, results, bestAvailable());
+}
+
+void MeanReversionBatch::run(int startDay, int endDay, vector<StrategyStats> &results, InstructionSet instructionSet) const
+{
+    int bands = getBandCount();
+    results.assign(bands, StrategyStats());
+    if (endDay <= startDay) {
+        return;
+    }
+
+    // Never run code the CPU cannot execute, whatever the caller asked for
+    if (instructionSet > bestAvailable()) {
+        instructionSet = bestAvailable();
+    }
+    int band = 0;
+#ifdef MEAN_REVERSION_BATCH_X86
+    if (instructionSet == AVX2) {
+        for (; band + 2 * AVX2_LANES <= bands; band += 2 * AVX2_LANES) {
+            runLanesAvx2<2>(prices, average, firstIndex, lowerFactors.data() + band, upperFactors.data() + band,
+                            startDay, endDay, results.data() + band);
+        }
+        for (; band + AVX2_LANES <= bands; band += AVX2_LANES) {
+            runLanesAvx2<1>(prices, average, firstIndex, lowerFactors.data() + band, upperFactors.data() + band,
+                            startDay, endDay, results.data() + band);
+        }
+    }
+#else
+    (void)instructionSet;
+#endif
+    // Bands left over from the last full register, or all of them without AVX2
+    for (; band < bands; band++) {
+        results[band] = MeanReversionKernel(average, firstIndex, lowerFactors[band], upperFactors[band]).backtest(prices, startDay, endDay);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef MEAN_REVERSION_BATCH_H
+#define MEAN_REVERSION_BATCH_H
+
+#include <vector>
+#include "Leaderboard.h"
+
+using namespace std;
+
+// Backtests many mean-reversion bands that share one moving-average series, such as every
+// threshold of one window in a MeanReversionStrategy grid, in a single pass over the days.
+// The price and the average are loaded once per day for all bands; each band's buy/sell
+// state machine and P&L bookkeeping run in one SIMD lane (four per AVX2 register), with
+// branch-free blends instead of jumps. Bands are compared as price < average * lowerFactor
+// and price > average * upperFactor exactly as MeanReversionKernel does, so every band's
+// stats are identical to backtesting it alone. CPUs without AVX2 backtest the bands one
+// after another.
+class MeanReversionBatch
+{
+public:
+    enum InstructionSet
+    {
+        SCALAR,
+        AVX2
+    };
+
+private:
+    const double *prices;
+    const double *average;
+    int firstIndex;
+    vector<double> lowerFactors;
+    vector<double> upperFactors;
+
+public:
+    // The average series starts at day firstIndex, as IndicatorEngine tables do
+    MeanReversionBatch(const double *prices, const double *average, int firstIndex);
+
+    // Adds the next band (see SignalRule::BAND); results come back in the order added
+    void addBand(double lowerFactor, double upperFactor);
+    int getBandCount() const;
+
+    static InstructionSet bestAvailable();
+
+    // Backtests days [startDay, endDay) for every band, closing positions on the last day.
+    // An instruction set the CPU lacks is lowered to bestAvailable().
+    void run(int startDay, int endDay, vector<StrategyStats> &results) const;
+    void run(int startDay, int endDay, vector<StrategyStats> &results, InstructionSet instructionSet) const;
+};
+
+#endif // MEAN_REVERSION_BATCH_H
@@ -1,34 +1,68 @@
 #include "MeanReversionStrategy.h"
+#include "Instrumentation.h"
+#include "LiveIndicators.h"
+#include "StrategyKernels.h"
 #include "Utils.h"
 #include <cmath>
 #include <iostream>
 
 MeanReversionStrategy::MeanReversionStrategy()
 :Strategy(), window(0), threshold(){
+    setShortcutOwner(typeid(MeanReversionStrategy));
 }
 
 MeanReversionStrategy::MeanReversionStrategy(const string &name, int window, int threshold)
 :Strategy(name), window(window), threshold(threshold){
+    setShortcutOwner(typeid(MeanReversionStrategy));
 }
 
 Action MeanReversionStrategy::decideAction(Market *market, int index, double currentHolding) const
 {
+    INSTRUMENT_SCOPE("MeanReversionStrategy::decideAction");
     double movingAvg = calculateMovingAverage(market, index, window);
     double currentPrice = market->getPrice(index);
-    
+
     double thresholdPercent = threshold / 100.0;
-    
-    if (currentHolding == 0.0) {
-        if (currentPrice < movingAvg * (1.0 - thresholdPercent)) {
-            return BUY;
-        }
-    } else if (currentHolding == 1.0) {
-        if (currentPrice > movingAvg * (1.0 + thresholdPercent)) {
-            return SELL;
-        }
-    }
-    
-    return HOLD;
+    return MeanReversionKernel::decideBand(currentPrice, movingAvg, 1.0 - thresholdPercent, 1.0 + thresholdPercent, currentHolding);
+}
+
+void MeanReversionStrategy::registerIndicators(IndicatorEngine &indicators) const
+{
+    indicators.requireSimpleAverage(window);
+}
+
+Action MeanReversionStrategy::decideFromIndicators(IndicatorEngine &indicators, int index, double currentHolding) const
+{
+    double movingAvg = calculateMovingAverage(indicators, index, window);
+    double currentPrice = indicators.getMarket()->getPrice(index);
+
+    double thresholdPercent = threshold / 100.0;
+    return MeanReversionKernel::decideBand(currentPrice, movingAvg, 1.0 - thresholdPercent, 1.0 + thresholdPercent, currentHolding);
+}
+
+bool MeanReversionStrategy::buildRule(IndicatorEngine &indicators, SignalRule &rule) const
+{
+    return makeRule(indicators, window, threshold, rule);
+}
+
+bool MeanReversionStrategy::buildLiveRule(LiveIndicators &indicators, SignalRule &rule) const
+{
+    double thresholdPercent = threshold / 100.0;
+    rule.kind = SignalRule::BAND;
+    rule.average = indicators.simpleAverage(window);
+    rule.lowerFactor = 1.0 - thresholdPercent;
+    rule.upperFactor = 1.0 + thresholdPercent;
+    return rule.average != nullptr;
+}
+
+bool MeanReversionStrategy::makeRule(IndicatorEngine &indicators, int window, int threshold, SignalRule &rule)
+{
+    double thresholdPercent = threshold / 100.0;
+    rule.kind = SignalRule::BAND;
+    rule.average = indicators.simpleAverageSeries(window);
+    rule.lowerFactor = 1.0 - thresholdPercent;
+    rule.upperFactor = 1.0 + thresholdPercent;
+    return rule.average != nullptr;
 }
 
 MeanReversionStrategy **MeanReversionStrategy::generateStrategySet(const string &baseName, int minWindow, int maxWindow, int windowStep, int minThreshold, int maxThreshold, int thresholdStep)
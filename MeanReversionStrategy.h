@@ -10,10 +10,19 @@ private:
     int window;
     int threshold;
 
+protected:
+    Action decideFromIndicators(IndicatorEngine &indicators, int index, double currentHolding) const override;
+    bool buildRule(IndicatorEngine &indicators, SignalRule &rule) const override;
+    bool buildLiveRule(LiveIndicators &indicators, SignalRule &rule) const override;
+
 public:
     MeanReversionStrategy();
     MeanReversionStrategy(const string &name, int window, int threshold);
+    using Strategy::decideAction;
     Action decideAction(Market *market, int index, double currentHolding) const override;
+    void registerIndicators(IndicatorEngine &indicators) const override;
+    // Rule for the given parameters without needing a strategy object (used by parameter sweeps)
+    static bool makeRule(IndicatorEngine &indicators, int window, int threshold, SignalRule &rule);
     static MeanReversionStrategy **generateStrategySet(const string &baseName, int minWindow, int maxWindow, int windowStep, int minThreshold, int maxThreshold, int thresholdStep);
 };
 
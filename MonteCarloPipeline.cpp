@@ -0,0 +1,159 @@
+#include "MonteCarloPipeline.h"
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include "Market.h"
+
+MonteCarloPipeline::MonteCarloPipeline(const MarketEnsemble &ensemble, const vector<const Strategy *> &strategies, int startDay, int endDay, const PipelineOptions &options)
+: ensemble(ensemble), strategies(strategies), startDay(startDay), endDay(endDay), options(options), chunkCount(0), mergeWindow(0), nextToMerge(0){
+    this->options.lanes = max(this->options.lanes, 1);
+    this->options.pathsPerChunk = max(this->options.pathsPerChunk, 1);
+    this->options.queueDepth = max(this->options.queueDepth, 1);
+    int paths = ensemble.getNumPaths();
+    chunkCount = (paths + this->options.pathsPerChunk - 1) / this->options.pathsPerChunk;
+    mergeWindow = 2 * this->options.lanes * this->options.queueDepth;
+}
+
+void MonteCarloPipeline::generate(int laneIndex)
+{
+    Lane &lane = *lanes[laneIndex];
+    int days = ensemble.getNumTradingDays();
+    for (int index = laneIndex; index < chunkCount; index += options.lanes) {
+        // Backpressure: a free buffer, and not too far ahead of the merge
+        while (index >= nextToMerge.load(memory_order_acquire) + mergeWindow) {
+            this_thread::yield();
+        }
+        Chunk *chunk;
+        while (!lane.free->tryPop(chunk)) {
+            this_thread::yield();
+        }
+        chunk->index = index;
+        chunk->firstPath = index * options.pathsPerChunk;
+        chunk->count = min(options.pathsPerChunk, ensemble.getNumPaths() - chunk->firstPath);
+        for (int k = 0; k < chunk->count; k++) {
+            ensemble.generatePath(chunk->firstPath + k, chunk->prices.data() + static_cast<size_t>(k) * days);
+        }
+        while (!lane.full->tryPush(chunk)) {
+            this_thread::yield();
+        }
+    }
+    lane.finished.store(true, memory_order_release);
+}
+
+void MonteCarloPipeline::evaluate(int laneIndex)
+{
+    Lane &lane = *lanes[laneIndex];
+    Partial partial;
+    for (;;) {
+        Chunk *chunk;
+        if (!lane.full->tryPop(chunk)) {
+            // Finished is set after the last push, so an empty queue seen afterwards stays empty
+            if (lane.finished.load(memory_order_acquire) && lane.full->empty()) {
+                break;
+            }
+            this_thread::yield();
+            continue;
+        }
+        int index = chunk->index;
+        evaluateChunk(*chunk, partial);
+        while (!lane.free->tryPush(chunk)) {
+            this_thread::yield();
+        }
+        merge(index, partial);
+    }
+}
+
+void MonteCarloPipeline::evaluateChunk(const Chunk &chunk, Partial &partial) const
+{
+    int count = static_cast<int>(strategies.size());
+    int days = ensemble.getNumTradingDays();
+    partial.profitSum.assign(count, 0.0);
+    partial.wins.assign(count, 0);
+    partial.bestSum = 0.0;
+
+    Market pathMarket(0, 0, 0, 0, -1);
+    for (int k = 0; k < chunk.count; k++) {
+        pathMarket.assignPrices(PriceView(chunk.prices.data() + static_cast<size_t>(k) * days, days));
+        IndicatorEngine indicators(&pathMarket, startDay, endDay);
+        int best = -1;
+        double bestProfit = -numeric_limits<double>::max();
+        for (int s = 0; s < count; s++) {
+            double profit = strategies[s]->backtest(indicators, startDay, endDay).profit;
+            partial.profitSum[s] += profit;
+            if (profit > bestProfit) {
+                best = s;
+                bestProfit = profit;
+            }
+        }
+        if (best >= 0) {
+            partial.wins[best]++;
+            partial.bestSum += bestProfit;
+        }
+    }
+}
+
+void MonteCarloPipeline::merge(int chunkIndex, Partial &partial)
+{
+    lock_guard<mutex> guard(mergeLock);
+    pending[chunkIndex].profitSum.swap(partial.profitSum);
+    pending[chunkIndex].wins.swap(partial.wins);
+    pending[chunkIndex].bestSum = partial.bestSum;
+
+    int next = nextToMerge.load(memory_order_relaxed);
+    while (!pending.empty() && pending.begin()->first == next) {
+        Partial &ready = pending.begin()->second;
+        for (size_t s = 0; s < strategies.size(); s++) {
+            result.meanProfit[s] += ready.profitSum[s];
+            result.wins[s] += ready.wins[s];
+        }
+        result.meanBestProfit += ready.bestSum;
+        pending.erase(pending.begin());
+        next++;
+    }
+    nextToMerge.store(next, memory_order_release);
+}
+
+MonteCarloResult MonteCarloPipeline::run()
+{
+    result = MonteCarloResult();
+    result.meanProfit.assign(strategies.size(), 0.0);
+    result.wins.assign(strategies.size(), 0);
+    nextToMerge.store(0);
+    pending.clear();
+    if (chunkCount == 0 || endDay <= startDay) {
+        return result;
+    }
+
+    int days = ensemble.getNumTradingDays();
+    lanes.clear();
+    for (int l = 0; l < options.lanes; l++) {
+        unique_ptr<Lane> lane(new Lane());
+        lane->full.reset(new SpscQueue<Chunk *>(options.queueDepth));
+        lane->free.reset(new SpscQueue<Chunk *>(options.queueDepth));
+        lane->finished.store(false);
+        for (int b = 0; b < options.queueDepth; b++) {
+            lane->buffers.push_back(unique_ptr<Chunk>(new Chunk()));
+            lane->buffers.back()->prices.resize(static_cast<size_t>(options.pathsPerChunk) * days);
+            lane->free->tryPush(lane->buffers.back().get());
+        }
+        lanes.push_back(move(lane));
+    }
+
+    vector<thread> threads;
+    for (int l = 0; l < options.lanes; l++) {
+        threads.push_back(thread(&MonteCarloPipeline::generate, this, l));
+        threads.push_back(thread(&MonteCarloPipeline::evaluate, this, l));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    lanes.clear();
+
+    result.paths = ensemble.getNumPaths();
+    for (size_t s = 0; s < strategies.size(); s++) {
+        result.meanProfit[s] /= result.paths;
+    }
+    result.meanBestProfit /= result.paths;
+    result.bufferedPathCapacity = static_cast<long long>(options.lanes) * options.queueDepth * options.pathsPerChunk;
+    return result;
+}
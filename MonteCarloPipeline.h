@@ -0,0 +1,101 @@
+#ifndef MONTE_CARLO_PIPELINE_H
+#define MONTE_CARLO_PIPELINE_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "MarketEnsemble.h"
+#include "SpscQueue.h"
+#include "Strategy.h"
+
+using namespace std;
+
+// Settings for TradingBot::runMonteCarlo. Each lane is one generator thread feeding one
+// evaluator thread through its own SpscQueue; a lane owns queueDepth chunk buffers of
+// pathsPerChunk paths, which bounds the prices held at once however many paths run.
+struct PipelineOptions
+{
+    int lanes;
+    int pathsPerChunk;
+    int queueDepth;
+
+    PipelineOptions() : lanes(1), pathsPerChunk(64), queueDepth(4) {}
+};
+
+// Per-strategy results over every path, indexed like the strategies evaluated
+struct MonteCarloResult
+{
+    int paths;
+    vector<double> meanProfit;
+    vector<int> wins;         // paths on which the strategy had the best profit (ties to the lower index)
+    double meanBestProfit;    // mean over paths of the best strategy's profit
+    long long bufferedPathCapacity; // paths the preallocated chunk buffers can hold, lanes * queueDepth * pathsPerChunk
+
+    MonteCarloResult() : paths(0), meanBestProfit(0.0), bufferedPathCapacity(0) {}
+};
+
+// Generates the paths of a MarketEnsemble chunk by chunk and backtests every strategy on
+// each path while later chunks are still being generated. Chunks go round-robin to the
+// lanes; generators block when their lane has no free buffer, and also when they run too
+// far ahead of the oldest chunk whose results have not been merged yet, so memory stays
+// bounded. Results are merged in chunk order and do not depend on the number of lanes.
+class MonteCarloPipeline
+{
+private:
+    struct Chunk
+    {
+        int index;
+        int firstPath;
+        int count;
+        vector<double> prices; // [path][day]
+    };
+
+    struct Lane
+    {
+        unique_ptr<SpscQueue<Chunk *>> full; // generator -> evaluator
+        unique_ptr<SpscQueue<Chunk *>> free; // evaluator -> generator, recycled buffers
+        vector<unique_ptr<Chunk>> buffers;
+        atomic<bool> finished;
+    };
+
+    struct Partial
+    {
+        vector<double> profitSum;
+        vector<int> wins;
+        double bestSum;
+    };
+
+    const MarketEnsemble &ensemble;
+    vector<const Strategy *> strategies;
+    int startDay;
+    int endDay;
+    PipelineOptions options;
+    int chunkCount;
+    int mergeWindow; // chunks a generator may run ahead of the next one to merge
+
+    vector<unique_ptr<Lane>> lanes;
+    mutex mergeLock;
+    map<int, Partial> pending; // evaluated chunks waiting for their predecessors
+    atomic<int> nextToMerge;
+    MonteCarloResult result;
+
+    void generate(int lane);
+    void evaluate(int lane);
+    void evaluateChunk(const Chunk &chunk, Partial &partial) const;
+    void merge(int chunkIndex, Partial &partial);
+
+public:
+    // Backtests days [startDay, endDay) of every path; strategies are not owned and must
+    // be safe to backtest from several threads at once (all built-in strategies are)
+    MonteCarloPipeline(const MarketEnsemble &ensemble, const vector<const Strategy *> &strategies, int startDay, int endDay, const PipelineOptions &options);
+
+    MonteCarloResult run();
+
+    // Prevent copying
+    MonteCarloPipeline(const MonteCarloPipeline &) = delete;
+    MonteCarloPipeline &operator=(const MonteCarloPipeline &) = delete;
+};
+
+#endif // MONTE_CARLO_PIPELINE_H
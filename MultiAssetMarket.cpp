@@ -0,0 +1,291 @@
+#include "MultiAssetMarket.h"
+#include "CounterRandom.h"
+#include "GbmKernel.h"
+#include "Utils.h"
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+// Draws correlated together per block; a block's [draw][asset] buffers stay in cache
+static const int DRAW_BLOCK = 64;
+
+MultiAssetMarket::MultiAssetMarket(const vector<double> &initialPrices, const vector<double> &expectedYearlyReturns,
+                                   const vector<double> &covariance, int numTradingDays, long long seed)
+: numAssets(static_cast<int>(initialPrices.size())), numTradingDays(numTradingDays > 0 ? numTradingDays : 0), seed(0),
+  initialPrices(initialPrices), expectedYearlyReturns(expectedYearlyReturns), threadCount(1), exactRounding(true)
+{
+    if (seed == -1) {
+        random_device device;
+        this->seed = (static_cast<uint64_t>(device()) << 32) | device();
+    } else {
+        this->seed = static_cast<uint64_t>(seed);
+    }
+
+    bool valid = true;
+    if (expectedYearlyReturns.size() != initialPrices.size()
+        || covariance.size() != initialPrices.size() * initialPrices.size()) {
+        cerr << "Multi-asset market needs one price and return per asset and a " << numAssets << "x" << numAssets
+             << " covariance matrix" << endl;
+        valid = false;
+    } else if (this->numTradingDays > 0 && numAssets > INT_MAX / this->numTradingDays) {
+        cerr << "Multi-asset market too large: " << numAssets << " assets of " << numTradingDays << " days" << endl;
+        valid = false;
+    } else {
+        valid = factorCorrelation(covariance);
+    }
+    if (!valid) {
+        numAssets = 0;
+        this->initialPrices.clear();
+        this->expectedYearlyReturns.clear();
+        volatilities.clear();
+        factor.clear();
+    }
+}
+
+// Factors the correlation matrix rather than the covariance, so that uncorrelated assets
+// get a factor of exactly 1 and draw exactly the normals MarketEnsemble would
+bool MultiAssetMarket::factorCorrelation(const vector<double> &covariance)
+{
+    int n = numAssets;
+    volatilities.assign(n, 0.0);
+    for (int i = 0; i < n; i++) {
+        double variance = covariance[static_cast<size_t>(i) * n + i];
+        if (!(variance >= 0.0) || std::isinf(variance)) {
+            cerr << "Invalid variance for asset " << i << ": " << variance << endl;
+            return false;
+        }
+        volatilities[i] = sqrt(variance);
+    }
+
+    vector<double> correlation(static_cast<size_t>(n) * n, 0.0);
+    for (int i = 0; i < n; i++) {
+        correlation[static_cast<size_t>(i) * n + i] = 1.0;
+        for (int j = 0; j < i; j++) {
+            double upper = covariance[static_cast<size_t>(j) * n + i];
+            double lower = covariance[static_cast<size_t>(i) * n + j];
+            double scale = volatilities[i] * volatilities[j];
+            if (!(fabs(upper - lower) <= 1e-9 * scale)) {
+                cerr << "Covariance matrix is not symmetric at (" << i << ", " << j << ")" << endl;
+                return false;
+            }
+            if (scale == 0.0 && lower != 0.0) {
+                cerr << "Covariance matrix is not positive semi-definite" << endl;
+                return false;
+            }
+            double value = scale > 0.0 ? lower / scale : 0.0;
+            correlation[static_cast<size_t>(i) * n + j] = value;
+            correlation[static_cast<size_t>(j) * n + i] = value;
+        }
+    }
+
+    // Cholesky-Banachiewicz, tolerating zero pivots (perfectly correlated assets): their
+    // column stays 0 as long as the rest of the column agrees
+    const double tolerance = 1e-9;
+    factor.assign(static_cast<size_t>(n) * n, 0.0);
+    for (int j = 0; j < n; j++) {
+        double *column = factor.data() + static_cast<size_t>(j) * n;
+        double pivot = correlation[static_cast<size_t>(j) * n + j];
+        for (int k = 0; k < j; k++) {
+            double entry = factor[static_cast<size_t>(k) * n + j];
+            pivot -= entry * entry;
+        }
+        if (pivot < -tolerance) {
+            cerr << "Covariance matrix is not positive semi-definite" << endl;
+            return false;
+        }
+        column[j] = pivot > tolerance ? sqrt(pivot) : 0.0;
+        for (int i = j + 1; i < n; i++) {
+            double value = correlation[static_cast<size_t>(i) * n + j];
+            for (int k = 0; k < j; k++) {
+                value -= factor[static_cast<size_t>(k) * n + i] * factor[static_cast<size_t>(k) * n + j];
+            }
+            if (column[j] > 0.0) {
+                column[i] = value / column[j];
+            } else if (fabs(value) > tolerance) {
+                cerr << "Covariance matrix is not positive semi-definite" << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+vector<double> MultiAssetMarket::uniformCovariance(int numAssets, double volatility, double correlation)
+{
+    int n = max(numAssets, 0);
+    vector<double> covariance(static_cast<size_t>(n) * n, volatility * volatility * correlation);
+    for (int i = 0; i < n; i++) {
+        covariance[static_cast<size_t>(i) * n + i] = volatility * volatility;
+    }
+    return covariance;
+}
+
+void MultiAssetMarket::setThreadCount(int threads)
+{
+    int resolved = threads > 0 ? threads : WorkStealingPool::defaultThreadCount();
+    if (resolved != threadCount) {
+        pool.reset();
+    }
+    threadCount = resolved;
+}
+
+int MultiAssetMarket::getThreadCount() const
+{
+    return threadCount;
+}
+
+void MultiAssetMarket::setExactRounding(bool exact)
+{
+    exactRounding = exact;
+}
+
+bool MultiAssetMarket::getExactRounding() const
+{
+    return exactRounding;
+}
+
+void MultiAssetMarket::parallelFor(int count, const function<void(int)> &body)
+{
+    if (threadCount > 1 && count > 1) {
+        if (!pool) {
+            pool.reset(new WorkStealingPool(threadCount));
+        }
+        pool->parallelFor(count, body);
+    } else {
+        for (int k = 0; k < count; k++) {
+            body(k);
+        }
+    }
+}
+
+// Same streams as MarketEnsemble::generatePath: draw d of asset a is half of the Philox
+// block (d / 2, 0, a, 0), written to out[d]
+void MultiAssetMarket::generateNormals(int asset, double *out) const
+{
+    Philox4x32 random(seed);
+    uint32_t counter[4] = {0, 0, static_cast<uint32_t>(asset), 0};
+    for (int draw = 0; draw < numTradingDays - 1; draw += 2) {
+        counter[0] = static_cast<uint32_t>(draw / 2);
+        double first, second;
+        random.normalPair(counter, first, second);
+        out[draw] = first;
+        if (draw + 1 < numTradingDays - 1) {
+            out[draw + 1] = second;
+        }
+    }
+}
+
+// Replaces draws [firstDraw, endDraw) of every asset, stored from day 1 of its path, with
+// L * z. Entry i sums its terms in column order whatever the block, so the result does
+// not depend on how draws are split between threads.
+void MultiAssetMarket::correlateDays(int firstDraw, int endDraw, double *allPrices) const
+{
+    int n = numAssets;
+    int count = endDraw - firstDraw;
+    vector<double> draws(static_cast<size_t>(count) * n);
+    vector<double> correlated(static_cast<size_t>(count) * n, 0.0);
+    for (int asset = 0; asset < n; asset++) {
+        const double *row = allPrices + static_cast<size_t>(asset) * numTradingDays + 1 + firstDraw;
+        for (int d = 0; d < count; d++) {
+            draws[static_cast<size_t>(d) * n + asset] = row[d];
+        }
+    }
+
+    for (int d = 0; d < count; d++) {
+        const double *z = draws.data() + static_cast<size_t>(d) * n;
+        double *__restrict w = correlated.data() + static_cast<size_t>(d) * n;
+        for (int j = 0; j < n; j++) {
+            const double *__restrict column = factor.data() + static_cast<size_t>(j) * n;
+            double zj = z[j];
+            for (int i = j; i < n; i++) {
+                w[i] += column[i] * zj;
+            }
+        }
+    }
+
+    for (int asset = 0; asset < n; asset++) {
+        double *row = allPrices + static_cast<size_t>(asset) * numTradingDays + 1 + firstDraw;
+        for (int d = 0; d < count; d++) {
+            row[d] = correlated[static_cast<size_t>(d) * n + asset];
+        }
+    }
+}
+
+void MultiAssetMarket::simulate()
+{
+    if (prices.size() != numAssets * numTradingDays) {
+        prices.resize(numAssets * numTradingDays);
+    }
+    if (numAssets == 0 || numTradingDays == 0) {
+        return;
+    }
+    double *allPrices = prices.data();
+
+    // Independent draws per asset, then correlated block by block, then compounded per asset
+    parallelFor(numAssets, [this, allPrices](int asset) {
+        generateNormals(asset, allPrices + static_cast<size_t>(asset) * numTradingDays + 1);
+    });
+    int draws = numTradingDays - 1;
+    int blocks = (draws + DRAW_BLOCK - 1) / DRAW_BLOCK;
+    parallelFor(blocks, [this, allPrices, draws](int block) {
+        correlateDays(block * DRAW_BLOCK, min(draws, (block + 1) * DRAW_BLOCK), allPrices);
+    });
+    double deltaT = 1.0 / TRADING_DAYS_PER_YEAR;
+    parallelFor(numAssets, [this, allPrices, deltaT](int asset) {
+        double volatility = volatilities[asset];
+        double drift = (expectedYearlyReturns[asset] - 0.5 * (volatility * volatility)) * deltaT;
+        double diffusion = volatility * sqrt(deltaT);
+        double *path = allPrices + static_cast<size_t>(asset) * numTradingDays;
+        GbmKernel::simulatePath(initialPrices[asset], drift, diffusion, path + 1, numTradingDays, exactRounding, path);
+    });
+}
+
+int MultiAssetMarket::getNumAssets() const
+{
+    return numAssets;
+}
+
+int MultiAssetMarket::getNumTradingDays() const
+{
+    return numTradingDays;
+}
+
+uint64_t MultiAssetMarket::getSeed() const
+{
+    return seed;
+}
+
+double MultiAssetMarket::getVolatility(int asset) const
+{
+    return asset >= 0 && asset < numAssets ? volatilities[asset] : 0.0;
+}
+
+double MultiAssetMarket::getCorrelationFactor(int row, int column) const
+{
+    if (row < 0 || row >= numAssets || column < 0 || column > row) {
+        return 0.0;
+    }
+    return factor[static_cast<size_t>(column) * numAssets + row];
+}
+
+PriceView MultiAssetMarket::getAsset(int asset) const
+{
+    if (asset < 0 || asset >= numAssets || prices.empty()) {
+        return PriceView();
+    }
+    return prices.view().subview(asset * numTradingDays, numTradingDays);
+}
+
+double MultiAssetMarket::getPrice(int asset, int day) const
+{
+    if (asset < 0 || asset >= numAssets || day < 0 || day >= numTradingDays || prices.empty()) {
+        return 0.0;
+    }
+    return prices[asset * numTradingDays + day];
+}
+
+PriceView MultiAssetMarket::getAllPrices() const
+{
+    return prices.view();
+}
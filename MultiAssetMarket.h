@@ -0,0 +1,84 @@
+#ifndef MULTI_ASSET_MARKET_H
+#define MULTI_ASSET_MARKET_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "PriceSeries.h"
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+// GBM price paths for a book of correlated assets. Daily log returns of asset i have drift
+// (expectedYearlyReturn[i] - covariance[i][i] / 2) * dt and covariance covariance * dt,
+// the same model Market uses for one asset with volatility sqrt(covariance[i][i]).
+//
+// The correlation matrix is factored once (Cholesky, L * L^T) when the market is built.
+// simulate() draws independent standard normals per asset, with Philox streams addressed by
+// (seed, asset, day) exactly like MarketEnsemble paths, then turns each day's draws z
+// into correlated ones L * z. That product runs column by column over the assets, so the
+// inner loop vectorizes across assets. Each asset's path is finally compounded by
+// GbmKernel. Prices are stored contiguously as [asset][day]. They are identical for any
+// thread count. With no correlation every asset's path equals the MarketEnsemble path of
+// the same index and parameters.
+class MultiAssetMarket
+{
+private:
+    int numAssets;
+    int numTradingDays;
+    uint64_t seed;
+    vector<double> initialPrices;
+    vector<double> expectedYearlyReturns;
+    vector<double> volatilities;
+    vector<double> factor; // Cholesky factor of the correlation matrix, [column][row], lower triangle
+    PriceSeries prices;
+    int threadCount;
+    bool exactRounding;
+    unique_ptr<WorkStealingPool> pool;
+
+    bool factorCorrelation(const vector<double> &covariance);
+    void generateNormals(int asset, double *out) const;
+    void correlateDays(int firstDraw, int endDraw, double *allPrices) const;
+    void parallelFor(int count, const function<void(int)> &body);
+
+public:
+    // covariance is numAssets x numAssets, row-major, of yearly log returns; it must be
+    // symmetric positive semi-definite (perfectly correlated assets are allowed). On
+    // invalid input an error is printed and the market has no assets. seed == -1 draws a
+    // seed from random_device; getSeed() reports it for reproduction.
+    MultiAssetMarket(const vector<double> &initialPrices, const vector<double> &expectedYearlyReturns,
+                     const vector<double> &covariance, int numTradingDays, long long seed = -1);
+
+    // Covariance for numAssets assets sharing one volatility and one pairwise correlation
+    static vector<double> uniformCovariance(int numAssets, double volatility, double correlation);
+
+    // Number of threads simulate() spreads work over: 1 (the default) runs serially,
+    // 0 uses every hardware thread. The generated prices do not depend on this setting.
+    void setThreadCount(int threads);
+    int getThreadCount() const;
+
+    // Same switch as Market::setExactRounding; on by default
+    void setExactRounding(bool exact);
+    bool getExactRounding() const;
+
+    // Generates every asset's path; the [asset][day] storage is allocated on the first call
+    void simulate();
+
+    int getNumAssets() const;
+    int getNumTradingDays() const;
+    uint64_t getSeed() const;
+    double getVolatility(int asset) const;
+    // Entry (row, column) of the correlation factor L, 0 above the diagonal
+    double getCorrelationFactor(int row, int column) const;
+
+    PriceView getAsset(int asset) const;
+    double getPrice(int asset, int day) const;
+    // All assets back to back, asset-major
+    PriceView getAllPrices() const;
+
+    // Prevent copying
+    MultiAssetMarket(const MultiAssetMarket &) = delete;
+    MultiAssetMarket &operator=(const MultiAssetMarket &) = delete;
+};
+
+#endif // MULTI_ASSET_MARKET_H
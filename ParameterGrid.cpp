@@ -0,0 +1,167 @@
+#include "ParameterGrid.h"
+#include <algorithm>
+#include "MeanReversionStrategy.h"
+#include "TrendFollowingStrategy.h"
+#include "WeightedTrendFollowingStrategy.h"
+
+ParameterGrid::ParameterGrid(Family family, const string &baseName, const ParameterRange &first, const ParameterRange &second)
+: family(family), baseName(baseName), firstRange(first), secondRange(second){
+}
+
+ParameterGrid::Family ParameterGrid::getFamily() const
+{
+    return family;
+}
+
+const ParameterRange &ParameterGrid::getFirstRange() const
+{
+    return firstRange;
+}
+
+const ParameterRange &ParameterGrid::getSecondRange() const
+{
+    return secondRange;
+}
+
+long long ParameterGrid::size() const
+{
+    return static_cast<long long>(firstRange.size()) * secondRange.size();
+}
+
+// First parameter in the outer loop, like generateStrategySet
+void ParameterGrid::getParameters(long long index, int &first, int &second) const
+{
+    int secondCount = secondRange.size();
+    first = firstRange.value(static_cast<int>(index / secondCount));
+    second = secondRange.value(static_cast<int>(index % secondCount));
+}
+
+string ParameterGrid::getName(long long index) const
+{
+    int first, second;
+    getParameters(index, first, second);
+    return baseName + "_" + to_string(first) + '_' + to_string(second);
+}
+
+Strategy *ParameterGrid::createStrategy(long long index) const
+{
+    int first, second;
+    getParameters(index, first, second);
+    switch (family) {
+    case WEIGHTED_TREND_FOLLOWING:
+        return new WeightedTrendFollowingStrategy(getName(index), first, second);
+    case MEAN_REVERSION:
+        return new MeanReversionStrategy(getName(index), first, second);
+    default:
+        return new TrendFollowingStrategy(getName(index), first, second);
+    }
+}
+
+Strategy *ParameterGrid::createStrategy(long long index, StrategyArena &arena) const
+{
+    int first, second;
+    getParameters(index, first, second);
+    switch (family) {
+    case WEIGHTED_TREND_FOLLOWING:
+        return arena.create<WeightedTrendFollowingStrategy>(getName(index), first, second);
+    case MEAN_REVERSION:
+        return arena.create<MeanReversionStrategy>(getName(index), first, second);
+    default:
+        return arena.create<TrendFollowingStrategy>(getName(index), first, second);
+    }
+}
+
+bool ParameterGrid::describeRule(IndicatorEngine &indicators, long long index, SignalRule &rule) const
+{
+    int first, second;
+    getParameters(index, first, second);
+    switch (family) {
+    case WEIGHTED_TREND_FOLLOWING:
+        return WeightedTrendFollowingStrategy::makeRule(indicators, first, second, rule);
+    case MEAN_REVERSION:
+        return MeanReversionStrategy::makeRule(indicators, first, second, rule);
+    default:
+        return TrendFollowingStrategy::makeRule(indicators, first, second, rule);
+    }
+}
+
+bool ParameterGrid::getCrossoverWindows(long long index, int &fastWindow, int &slowWindow) const
+{
+    if (family != TREND_FOLLOWING) {
+        return false;
+    }
+    getParameters(index, fastWindow, slowWindow);
+    return fastWindow > 0 && slowWindow > 0;
+}
+
+void ParameterSweep::addGrid(const ParameterGrid &grid)
+{
+    offsets.push_back(size());
+    grids.push_back(grid);
+}
+
+int ParameterSweep::getGridCount() const
+{
+    return static_cast<int>(grids.size());
+}
+
+const ParameterGrid &ParameterSweep::getGrid(int grid) const
+{
+    return grids[grid];
+}
+
+long long ParameterSweep::size() const
+{
+    return grids.empty() ? 0 : offsets.back() + grids.back().size();
+}
+
+vector<int> ParameterSweep::getCrossoverWindows() const
+{
+    vector<int> windows;
+    for (size_t grid = 0; grid < grids.size(); grid++) {
+        if (grids[grid].getFamily() != ParameterGrid::TREND_FOLLOWING) {
+            continue;
+        }
+        const ParameterRange &first = grids[grid].getFirstRange();
+        const ParameterRange &second = grids[grid].getSecondRange();
+        for (int k = 0; k < first.size(); k++) {
+            windows.push_back(first.value(k));
+        }
+        for (int k = 0; k < second.size(); k++) {
+            windows.push_back(second.value(k));
+        }
+    }
+    return windows;
+}
+
+bool ParameterSweep::locate(long long id, int &grid, long long &index) const
+{
+    if (id < 0 || id >= size()) {
+        return false;
+    }
+    // Last grid starting at or before id; empty grids share their successor's offset
+    grid = static_cast<int>(upper_bound(offsets.begin(), offsets.end(), id) - offsets.begin()) - 1;
+    index = id - offsets[grid];
+    return true;
+}
+
+string ParameterSweep::getName(long long id) const
+{
+    int grid;
+    long long index;
+    return locate(id, grid, index) ? grids[grid].getName(index) : string();
+}
+
+Strategy *ParameterSweep::createStrategy(long long id) const
+{
+    int grid;
+    long long index;
+    return locate(id, grid, index) ? grids[grid].createStrategy(index) : nullptr;
+}
+
+Strategy *ParameterSweep::createStrategy(long long id, StrategyArena &arena) const
+{
+    int grid;
+    long long index;
+    return locate(id, grid, index) ? grids[grid].createStrategy(index, arena) : nullptr;
+}
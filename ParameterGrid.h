@@ -0,0 +1,89 @@
+#ifndef PARAMETER_GRID_H
+#define PARAMETER_GRID_H
+
+#include <string>
+#include <vector>
+#include "IndicatorEngine.h"
+#include "Strategy.h"
+#include "StrategyArena.h"
+
+using namespace std;
+
+// Inclusive range of integer parameter values: first, first + step, ... up to last
+struct ParameterRange
+{
+    int first;
+    int last;
+    int step;
+
+    ParameterRange() : first(0), last(0), step(1) {}
+    ParameterRange(int first, int last, int step) : first(first), last(last), step(step) {}
+
+    int size() const { return step > 0 && last >= first ? (last - first) / step + 1 : 0; }
+    int value(int index) const { return first + index * step; }
+};
+
+// Lazy description of every strategy of one family over two parameter ranges, in the same
+// order and with the same names generateStrategySet would produce. Combinations are
+// addressed by index and nothing is allocated per combination until asked for.
+class ParameterGrid
+{
+public:
+    enum Family
+    {
+        TREND_FOLLOWING,          // (short window, long window)
+        WEIGHTED_TREND_FOLLOWING, // (short window, long window)
+        MEAN_REVERSION            // (window, threshold)
+    };
+
+private:
+    Family family;
+    string baseName;
+    ParameterRange firstRange;
+    ParameterRange secondRange;
+
+public:
+    ParameterGrid(Family family, const string &baseName, const ParameterRange &first, const ParameterRange &second);
+
+    Family getFamily() const;
+    const ParameterRange &getFirstRange() const;
+    const ParameterRange &getSecondRange() const;
+    long long size() const;
+
+    void getParameters(long long index, int &first, int &second) const;
+    string getName(long long index) const;
+    // Caller owns the returned strategy
+    Strategy *createStrategy(long long index) const;
+    // Same strategy constructed in arena, which owns it
+    Strategy *createStrategy(long long index, StrategyArena &arena) const;
+    // Same rule createStrategy(index)->describeRule would give, without the object
+    bool describeRule(IndicatorEngine &indicators, long long index, SignalRule &rule) const;
+    // Windows of a simple trend-following combination whose crossover signals can come
+    // from a SimpleAverageTable; false for other families and non-positive windows
+    bool getCrossoverWindows(long long index, int &fastWindow, int &slowWindow) const;
+};
+
+// Several grids swept as one, with combination ids running through the grids in order
+class ParameterSweep
+{
+private:
+    vector<ParameterGrid> grids;
+    vector<long long> offsets; // id of each grid's first combination
+
+public:
+    void addGrid(const ParameterGrid &grid);
+    int getGridCount() const;
+    const ParameterGrid &getGrid(int grid) const;
+    long long size() const;
+
+    // Finds the grid and the index within it for a sweep-wide id; false if out of range
+    bool locate(long long id, int &grid, long long &index) const;
+    string getName(long long id) const;
+    Strategy *createStrategy(long long id) const;
+    Strategy *createStrategy(long long id, StrategyArena &arena) const;
+
+    // Every window of the simple trend-following grids, to build one SimpleAverageTable for all
+    vector<int> getCrossoverWindows() const;
+};
+
+#endif // PARAMETER_GRID_H
@@ -0,0 +1,46 @@
+#include "PriceRing.h"
+
+static long long roundUpToPowerOfTwo(int capacity)
+{
+    long long size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    return size;
+}
+
+PriceRing::PriceRing(int capacity)
+: values(roundUpToPowerOfTwo(capacity), 0.0), mask(static_cast<long long>(values.size()) - 1), dayCount(0){
+}
+
+void PriceRing::reserve(int capacity)
+{
+    long long size = roundUpToPowerOfTwo(capacity);
+    if (size <= static_cast<long long>(values.size())) {
+        return;
+    }
+    vector<double> grown(size, 0.0);
+    long long newMask = size - 1;
+    long long oldest = dayCount - static_cast<long long>(values.size());
+    for (long long day = oldest < 0 ? 0 : oldest; day < dayCount; day++) {
+        grown[day & newMask] = values[day & mask];
+    }
+    values.swap(grown);
+    mask = newMask;
+}
+
+void PriceRing::append(double price)
+{
+    values[dayCount & mask] = price;
+    dayCount++;
+}
+
+int PriceRing::getCapacity() const
+{
+    return static_cast<int>(values.size());
+}
+
+long long PriceRing::getDayCount() const
+{
+    return dayCount;
+}
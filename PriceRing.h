@@ -0,0 +1,38 @@
+#ifndef PRICE_RING_H
+#define PRICE_RING_H
+
+#include <vector>
+
+using namespace std;
+
+// Most recent prices of a live feed in a fixed ring buffer. Days are numbered from the
+// first price ever appended; only the last getCapacity() of them are kept, so memory stays
+// constant however long the feed runs. Appending is O(1) and never allocates.
+class PriceRing
+{
+private:
+    vector<double> values;
+    long long mask;      // capacity - 1; the capacity is a power of two
+    long long dayCount;  // prices appended so far
+
+public:
+    // Holds at least capacity prices (rounded up to a power of two, minimum 1)
+    explicit PriceRing(int capacity = 1);
+
+    // Grows the ring to hold at least capacity prices, keeping the ones it holds
+    void reserve(int capacity);
+
+    void append(double price);
+
+    int getCapacity() const;
+    long long getDayCount() const;
+    bool empty() const { return dayCount == 0; }
+    // True while day is one of the prices still held
+    bool holds(long long day) const { return day >= 0 && day < dayCount && day >= dayCount - static_cast<long long>(values.size()); }
+
+    // Price of a held day, see holds()
+    double operator[](long long day) const { return values[day & mask]; }
+    double getLastPrice() const { return values[(dayCount - 1) & mask]; }
+};
+
+#endif // PRICE_RING_H
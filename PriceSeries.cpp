@@ -0,0 +1,122 @@
+#include "PriceSeries.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h> // For _aligned_malloc on Windows
+#endif
+
+PriceView::PriceView()
+: first(nullptr), count(0){
+}
+
+PriceView::PriceView(const double *first, int count)
+: first(first), count(count){
+}
+
+PriceView PriceView::subview(int offset, int length) const
+{
+    if (offset < 0) {
+        offset = 0;
+    }
+    if (offset > count) {
+        offset = count;
+    }
+    if (length < 0 || length > count - offset) {
+        length = count - offset;
+    }
+    return PriceView(first + offset, length);
+}
+
+double *PriceSeries::allocate(int count)
+{
+    if (count <= 0) {
+        return nullptr;
+    }
+
+    size_t bytes = static_cast<size_t>(count) * sizeof(double);
+#ifdef _WIN32
+    void *memory = _aligned_malloc(bytes, ALIGNMENT);
+#else
+    void *memory = nullptr;
+    if (posix_memalign(&memory, ALIGNMENT, bytes) != 0) {
+        memory = nullptr;
+    }
+#endif
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return static_cast<double *>(memory);
+}
+
+void PriceSeries::release(double *values)
+{
+#ifdef _WIN32
+    _aligned_free(values);
+#else
+    free(values);
+#endif
+}
+
+PriceSeries::PriceSeries()
+: values(nullptr), count(0){
+}
+
+PriceSeries::PriceSeries(int count)
+: values(nullptr), count(0){
+    resize(count);
+}
+
+PriceSeries::PriceSeries(const PriceSeries &other)
+: values(allocate(other.count)), count(other.count > 0 ? other.count : 0){
+    for (int i = 0; i < count; i++) {
+        values[i] = other.values[i];
+    }
+}
+
+PriceSeries::PriceSeries(PriceSeries &&other)
+: values(other.values), count(other.count){
+    other.values = nullptr;
+    other.count = 0;
+}
+
+PriceSeries::~PriceSeries()
+{
+    release(values);
+    values = nullptr;
+}
+
+PriceSeries &PriceSeries::operator=(PriceSeries other)
+{
+    swap(other);
+    return *this;
+}
+
+void PriceSeries::swap(PriceSeries &other)
+{
+    double *tmpValues = values;
+    values = other.values;
+    other.values = tmpValues;
+
+    int tmpCount = count;
+    count = other.count;
+    other.count = tmpCount;
+}
+
+void PriceSeries::resize(int newCount)
+{
+    double *newValues = allocate(newCount);
+    release(values);
+    values = newValues;
+    count = newCount > 0 ? newCount : 0;
+    for (int i = 0; i < count; i++) {
+        values[i] = 0.0;
+    }
+}
+
+void PriceSeries::truncate(int newCount)
+{
+    if (newCount >= 0 && newCount < count) {
+        count = newCount;
+    }
+}
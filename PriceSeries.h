@@ -0,0 +1,72 @@
+#ifndef PRICE_SERIES_H
+#define PRICE_SERIES_H
+
+#include <cstddef>
+
+using namespace std;
+
+// Read-only, non-owning window over a contiguous run of prices.
+// Cheap to copy; valid only while the owning PriceSeries is alive and unchanged.
+class PriceView
+{
+private:
+    const double *first;
+    int count;
+
+public:
+    PriceView();
+    PriceView(const double *first, int count);
+
+    const double *data() const { return first; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    const double &operator[](int index) const { return first[index]; }
+    const double *begin() const { return first; }
+    const double *end() const { return first + count; }
+
+    PriceView subview(int offset, int length) const;
+};
+
+// Contiguous, cache-line aligned storage for one price per trading day.
+class PriceSeries
+{
+private:
+    double *values;
+    int count;
+
+    static double *allocate(int count);
+    static void release(double *values);
+
+public:
+    static const size_t ALIGNMENT = 64;
+
+    PriceSeries();
+    explicit PriceSeries(int count);
+    PriceSeries(const PriceSeries &other);
+    PriceSeries(PriceSeries &&other);
+    ~PriceSeries();
+
+    PriceSeries &operator=(PriceSeries other);
+    void swap(PriceSeries &other);
+
+    // Reallocates to hold count prices, all set to 0.0. Previous contents are discarded.
+    void resize(int count);
+
+    // Shrinks the logical size without reallocating; the first count prices are kept
+    void truncate(int count);
+
+    double *data() { return values; }
+    const double *data() const { return values; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    double &operator[](int index) { return values[index]; }
+    const double &operator[](int index) const { return values[index]; }
+    double *begin() { return values; }
+    double *end() { return values + count; }
+    const double *begin() const { return values; }
+    const double *end() const { return values + count; }
+
+    PriceView view() const { return PriceView(values, count); }
+};
+
+#endif // PRICE_SERIES_H
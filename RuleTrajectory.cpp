@@ -0,0 +1,125 @@
+#include "RuleTrajectory.h"
+#include <algorithm>
+#include "StrategyKernels.h"
+
+RuleTrajectory::RuleTrajectory()
+: prices(nullptr), seriesFirstIndex(0), firstDay(0), endDay(0){
+}
+
+template <class Kernel>
+void RuleTrajectory::trace(const Kernel &kernel)
+{
+    int days = endDay - firstDay;
+    holdingAfter.resize(days);
+    nextBuy.resize(days + 1);
+    buyDays.clear();
+    sellDays.clear();
+    profitPrefix.assign(1, 0.0);
+
+    double holding = 0.0;
+    for (int day = firstDay; day < endDay; day++) {
+        Action action = kernel.decideDay(prices, day, holding);
+        if (action == BUY && holding == 0.0) {
+            buyDays.push_back(day);
+            sellDays.push_back(endDay);
+            holding = 1.0;
+        } else if (action == SELL && holding == 1.0) {
+            sellDays.back() = day;
+            profitPrefix.push_back(profitPrefix.back() + (prices[day] - prices[buyDays.back()]));
+            holding = 0.0;
+        }
+        holdingAfter[day - firstDay] = holding == 1.0 ? 1 : 0;
+    }
+    if (holding == 1.0) {
+        // Still open at the end: never counted by a window, which closes it itself
+        profitPrefix.push_back(profitPrefix.back());
+    }
+
+    // Buy signals seen from a flat position, scanned backwards
+    nextBuy[days] = endDay;
+    for (int day = endDay - 1; day >= firstDay; day--) {
+        nextBuy[day - firstDay] = kernel.decideDay(prices, day, 0.0) == BUY ? day : nextBuy[day - firstDay + 1];
+    }
+}
+
+void RuleTrajectory::build(const SignalRule &rule, const double *prices, int seriesFirstIndex, int firstDay, int endDay)
+{
+    this->rule = rule;
+    this->prices = prices;
+    this->seriesFirstIndex = seriesFirstIndex;
+    this->firstDay = firstDay;
+    this->endDay = max(endDay, firstDay);
+
+    if (rule.kind == SignalRule::BAND) {
+        trace(MeanReversionKernel(rule.average, seriesFirstIndex, rule.lowerFactor, rule.upperFactor));
+    } else {
+        trace(TrendFollowingKernel(rule.fast, rule.slow, seriesFirstIndex));
+    }
+}
+
+void RuleTrajectory::buildCrossover(const unsigned char *signals, const double *prices, int firstDay, int endDay)
+{
+    // windowProfit only re-runs the rule for band rules, so the crossover series are never read
+    this->rule = SignalRule();
+    this->prices = prices;
+    this->seriesFirstIndex = firstDay;
+    this->firstDay = firstDay;
+    this->endDay = max(endDay, firstDay);
+    trace(CrossoverSignalKernel(signals, firstDay));
+}
+
+int RuleTrajectory::getFirstDay() const
+{
+    return firstDay;
+}
+
+int RuleTrajectory::getEndDay() const
+{
+    return endDay;
+}
+
+int RuleTrajectory::getTradeCount() const
+{
+    return static_cast<int>(buyDays.size());
+}
+
+double RuleTrajectory::windowProfit(int startDay, int endDay) const
+{
+    if (endDay <= startDay) {
+        return 0.0;
+    }
+    int lastDay = endDay - 1;
+    int tradeCount = static_cast<int>(buyDays.size());
+
+    // First trade of the long run that the window shares: the first one bought at or after startDay
+    int shared = static_cast<int>(lower_bound(buyDays.begin(), buyDays.end(), startDay) - buyDays.begin());
+    double profit = 0.0;
+
+    if (startDay > firstDay && holdingAfter[startDay - 1 - firstDay]) {
+        // The long run holds trade shared - 1 into the window, which starts flat. The window
+        // buys at the next buy signal; if that comes before the long run's sale, it holds
+        // the same position from then on and sells with it. Otherwise nothing is held
+        // until the long run is flat too, and the two agree from there.
+        int sellDay = sellDays[shared - 1];
+        int buyDay = nextBuy[startDay - firstDay];
+        if (buyDay == sellDay && buyDay < this->endDay) {
+            // Buys on the day the long run sells (overlapping bands): no shortcut
+            return backtestRule(rule, prices, seriesFirstIndex, startDay, endDay).profit;
+        }
+        if (buyDay < sellDay) {
+            if (sellDay > lastDay) {
+                return buyDay <= lastDay ? prices[lastDay] - prices[buyDay] : 0.0;
+            }
+            profit = prices[sellDay] - prices[buyDay];
+        }
+    }
+
+    // Shared trades completed by lastDay, then the one still open at lastDay, if any
+    int open = static_cast<int>(upper_bound(sellDays.begin(), sellDays.end(), lastDay) - sellDays.begin());
+    open = max(open, shared);
+    profit += profitPrefix[open] - profitPrefix[shared];
+    if (open < tradeCount && buyDays[open] <= lastDay) {
+        profit += prices[lastDay] - prices[buyDays[open]];
+    }
+    return profit;
+}
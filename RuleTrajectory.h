@@ -0,0 +1,54 @@
+#ifndef RULE_TRAJECTORY_H
+#define RULE_TRAJECTORY_H
+
+#include <vector>
+#include "Strategy.h"
+
+using namespace std;
+
+// One backtest of a SignalRule over a long day range [firstDay, endDay), kept so that the
+// profit of any window inside it can be read off without re-running the window. A rule's
+// decision depends only on the day and whether a position is held, so a backtest that
+// starts flat at day s follows the long run's trades as soon as both hold the same
+// position. Until then they differ by at most one trade. windowProfit therefore needs
+// only the trade open at s, the next buy signal after s and prefix sums of the trade
+// profits: O(log trades) per window, against O(window) for a fresh backtest.
+class RuleTrajectory
+{
+private:
+    SignalRule rule;
+    const double *prices;
+    int seriesFirstIndex;
+    int firstDay;
+    int endDay;
+
+    vector<signed char> holdingAfter; // position after each day, indexed by day - firstDay
+    vector<int> nextBuy;              // first day >= day that buys from flat, endDay if none
+    vector<int> buyDays;              // trades in order; sellDays is endDay while still open
+    vector<int> sellDays;
+    vector<double> profitPrefix;      // profitPrefix[k]: summed profit of completed trades before k
+
+    template <class Kernel>
+    void trace(const Kernel &kernel);
+
+public:
+    RuleTrajectory();
+
+    // Backtests rule over [firstDay, endDay); the rule's series start at seriesFirstIndex,
+    // which must not be after firstDay. Buffers are reused across calls.
+    void build(const SignalRule &rule, const double *prices, int seriesFirstIndex, int firstDay, int endDay);
+
+    // Same for a trend-following rule given as crossover signals, signals[day - firstDay]
+    // for every day of [firstDay, endDay) (see SimpleAverageTable::crossoverSignals)
+    void buildCrossover(const unsigned char *signals, const double *prices, int firstDay, int endDay);
+
+    int getFirstDay() const;
+    int getEndDay() const;
+    int getTradeCount() const;
+
+    // Profit of a backtest of days [startDay, endDay) within the built range, equal to
+    // backtestRule over the same days to within rounding of the summation order
+    double windowProfit(int startDay, int endDay) const;
+};
+
+#endif // RULE_TRAJECTORY_H
@@ -0,0 +1,191 @@
+#include "SignalHistory.h"
+#include <algorithm>
+
+static const int WORD_BITS = 64;
+
+SignalHistory::SignalHistory(int firstDay, int endDay, int rows)
+: firstDay(firstDay), endDay(max(endDay, firstDay)), wordsPerRow(0){
+    wordsPerRow = (this->endDay - firstDay + WORD_BITS - 1) / WORD_BITS;
+    words.assign(static_cast<size_t>(max(rows, 0)) * wordsPerRow, 0);
+}
+
+int SignalHistory::getFirstDay() const
+{
+    return firstDay;
+}
+
+int SignalHistory::getEndDay() const
+{
+    return endDay;
+}
+
+int SignalHistory::getRowCount() const
+{
+    return wordsPerRow > 0 ? static_cast<int>(words.size() / wordsPerRow) : 0;
+}
+
+size_t SignalHistory::getMemoryBytes() const
+{
+    return words.size() * sizeof(uint64_t);
+}
+
+int SignalHistory::addRow()
+{
+    int row = getRowCount();
+    words.resize(words.size() + wordsPerRow, 0);
+    return row;
+}
+
+void SignalHistory::setRow(int row, const unsigned char *signals)
+{
+    uint64_t *rowWords = words.data() + static_cast<size_t>(row) * wordsPerRow;
+    int days = endDay - firstDay;
+    for (int w = 0; w < wordsPerRow; w++) {
+        int count = min(WORD_BITS, days - w * WORD_BITS);
+        const unsigned char *chunk = signals + w * WORD_BITS;
+        uint64_t packed = 0;
+        for (int i = 0; i < count; i++) {
+            packed |= static_cast<uint64_t>(chunk[i] != 0) << i;
+        }
+        rowWords[w] = packed;
+    }
+}
+
+bool SignalHistory::get(int row, int day) const
+{
+    int offset = day - firstDay;
+    return (words[static_cast<size_t>(row) * wordsPerRow + offset / WORD_BITS] >> (offset % WORD_BITS)) & 1;
+}
+
+// Calls visitor.enter(day) and visitor.exit(day) at each change of condition inside
+// [startDay, endDay), in day order, as seen by a backtest that starts flat at startDay
+template <class Visitor>
+void SignalHistory::forEachTransition(int row, int startDay, int endDay, Visitor &visitor) const
+{
+    const uint64_t *rowWords = words.data() + static_cast<size_t>(row) * wordsPerRow;
+    int begin = startDay - firstDay;
+    int end = endDay - firstDay;
+    int lastWord = (end - 1) / WORD_BITS;
+    uint64_t carry = 0; // condition on the previous day, the top bit of the previous word
+    for (int w = begin / WORD_BITS; w <= lastWord; w++) {
+        uint64_t window = ~0ULL;
+        if (w == begin / WORD_BITS) {
+            window &= ~0ULL << (begin % WORD_BITS);
+        }
+        if (w == lastWord && end % WORD_BITS != 0) {
+            window &= (1ULL << (end % WORD_BITS)) - 1;
+        }
+        uint64_t bits = rowWords[w] & window;
+        uint64_t changes = (bits ^ ((bits << 1) | carry)) & window;
+        carry = bits >> (WORD_BITS - 1);
+        while (changes != 0) {
+            int bit = __builtin_ctzll(changes);
+            changes &= changes - 1;
+            int day = firstDay + w * WORD_BITS + bit;
+            if ((bits >> bit) & 1) {
+                visitor.enter(day);
+            } else {
+                visitor.exit(day);
+            }
+        }
+    }
+}
+
+// Trade bookkeeping of PositionTracker in the same operations, applied at transitions only
+struct TransitionProfit
+{
+    const double *prices;
+    double profit;
+    double buyPrice;
+    int buyDay;
+    int tradeCount;
+    int winningTrades;
+
+    explicit TransitionProfit(const double *prices)
+    : prices(prices), profit(0.0), buyPrice(0.0), buyDay(-1), tradeCount(0), winningTrades(0) {}
+
+    void enter(int day)
+    {
+        buyPrice = prices[day];
+        buyDay = day;
+    }
+
+    void exit(int day)
+    {
+        double tradeProfit = prices[day] - buyPrice;
+        profit += tradeProfit;
+        tradeCount++;
+        winningTrades += tradeProfit > 0.0 ? 1 : 0;
+        buyDay = -1;
+    }
+};
+
+// Adds the marked-to-market drawdown. A flat day's equity repeats the one of the exit before
+// it and max() is idempotent, so only held days and exit days change the running maxima.
+struct TransitionStats : TransitionProfit
+{
+    double peakEquity;
+    double maxDrawdown;
+    int exposureDays;
+
+    explicit TransitionStats(const double *prices)
+    : TransitionProfit(prices), peakEquity(0.0), maxDrawdown(0.0), exposureDays(0) {}
+
+    void mark(double equity)
+    {
+        peakEquity = max(peakEquity, equity);
+        maxDrawdown = max(maxDrawdown, peakEquity - equity);
+    }
+
+    void markHeld(int untilDay)
+    {
+        for (int day = buyDay; day < untilDay; day++) {
+            mark(profit + (prices[day] - buyPrice));
+        }
+        exposureDays += untilDay - buyDay;
+    }
+
+    void exit(int day)
+    {
+        markHeld(day);
+        TransitionProfit::exit(day);
+        mark(profit);
+    }
+};
+
+StrategyStats SignalHistory::backtest(int row, const double *prices, int startDay, int endDay) const
+{
+    StrategyStats stats;
+    startDay = max(startDay, firstDay);
+    endDay = min(endDay, this->endDay);
+    if (endDay <= startDay) {
+        return stats;
+    }
+    TransitionStats trades(prices);
+    forEachTransition(row, startDay, endDay, trades);
+    if (trades.buyDay >= 0) {
+        trades.markHeld(endDay);
+        trades.TransitionProfit::exit(endDay - 1);
+    }
+    stats.profit = trades.profit;
+    stats.tradeCount = trades.tradeCount;
+    stats.winningTrades = trades.winningTrades;
+    stats.maxDrawdown = trades.maxDrawdown;
+    stats.exposureDays = trades.exposureDays;
+    return stats;
+}
+
+double SignalHistory::windowProfit(int row, const double *prices, int startDay, int endDay) const
+{
+    startDay = max(startDay, firstDay);
+    endDay = min(endDay, this->endDay);
+    if (endDay <= startDay) {
+        return 0.0;
+    }
+    TransitionProfit trades(prices);
+    forEachTransition(row, startDay, endDay, trades);
+    if (trades.buyDay >= 0) {
+        trades.exit(endDay - 1);
+    }
+    return trades.profit;
+}
@@ -0,0 +1,53 @@
+#ifndef SIGNAL_HISTORY_H
+#define SIGNAL_HISTORY_H
+
+#include <cstdint>
+#include <vector>
+#include "Leaderboard.h"
+
+using namespace std;
+
+// Per-day conditions of many crossover-style strategies over days [firstDay, endDay),
+// packed 64 days to a word with one row of words per strategy: a 10-year history costs
+// 320 bytes per strategy, so millions of them fit in memory at once.
+//
+// While its condition holds a crossover strategy is in the market and otherwise it is flat,
+// so its position on each day is the condition bit itself. Entries and exits are the days
+// where a bit differs from the one before; they are found a word at a time with shifts and
+// XOR, and visited with count-trailing-zeros, skipping every day in between. Any window
+// inside the range can be rescored from the bits alone, without the indicators behind them.
+class SignalHistory
+{
+private:
+    int firstDay;
+    int endDay;
+    int wordsPerRow;
+    vector<uint64_t> words; // [row][word], bit i of word w is day firstDay + 64 * w + i
+
+    template <class Visitor>
+    void forEachTransition(int row, int startDay, int endDay, Visitor &visitor) const;
+
+public:
+    SignalHistory(int firstDay, int endDay, int rows = 0);
+
+    int getFirstDay() const;
+    int getEndDay() const;
+    int getRowCount() const;
+    size_t getMemoryBytes() const;
+
+    // Appends a row with all conditions false and returns its index
+    int addRow();
+    // Packs signals[day - firstDay] for every day of the range; nonzero means the condition
+    // holds (see SimpleAverageTable::crossoverSignals). Distinct rows may be set concurrently.
+    void setRow(int row, const unsigned char *signals);
+    bool get(int row, int day) const;
+
+    // Same stats as CrossoverSignalKernel over days [startDay, endDay) of the range, starting
+    // flat and closing on the last day. Flat days are skipped; held days are still walked
+    // for the drawdown.
+    StrategyStats backtest(int row, const double *prices, int startDay, int endDay) const;
+    // Profit of the same backtest, read from the entry and exit days only
+    double windowProfit(int row, const double *prices, int startDay, int endDay) const;
+};
+
+#endif // SIGNAL_HISTORY_H
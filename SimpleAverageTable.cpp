@@ -0,0 +1,132 @@
+#include "SimpleAverageTable.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Instrumentation.h"
+
+SimpleAverageTable::SimpleAverageTable(PriceView prices, int firstIndex, int endIndex, const vector<int> &windows)
+: prices(prices), firstIndex(max(firstIndex, 0)), endIndex(min(endIndex, prices.size())), baseIndex(0){
+    if (this->endIndex < this->firstIndex) {
+        this->endIndex = this->firstIndex;
+    }
+    INSTRUMENT_SCOPE("SimpleAverageTable::build");
+
+    int maxWindow = 0;
+    for (size_t k = 0; k < windows.size(); k++) {
+        maxWindow = max(maxWindow, windows[k]);
+    }
+    rowOf.assign(maxWindow + 1, -1);
+    vector<int> rowWindows;
+    for (size_t k = 0; k < windows.size(); k++) {
+        if (windows[k] > 0 && rowOf[windows[k]] < 0) {
+            rowOf[windows[k]] = static_cast<int>(rowWindows.size());
+            rowWindows.push_back(windows[k]);
+        }
+    }
+    int n = days();
+    if (rowWindows.empty() || n == 0) {
+        return;
+    }
+    INSTRUMENT_ITEMS("entries", static_cast<long long>(rowWindows.size()) * n);
+
+    // One pass: prefix[k] and magnitude[k] sum prices[baseIndex, baseIndex + k) and their
+    // absolute values; the latter bounds the rounding error of every average
+    baseIndex = max(this->firstIndex - maxWindow + 1, 0);
+    int span = this->endIndex - baseIndex;
+    vector<double> prefix(span + 1, 0.0);
+    vector<double> magnitude(span + 1, 0.0);
+    for (int k = 0; k < span; k++) {
+        prefix[k + 1] = prefix[k] + prices[baseIndex + k];
+        magnitude[k + 1] = magnitude[k] + fabs(prices[baseIndex + k]);
+    }
+
+    // A k-term sum of doubles is off by at most about k*eps*(sum of magnitudes), for the
+    // prefix sums and for the reference's c-term window sum alike, plus a rounding or two
+    // for the subtraction and division. Twice that covers the higher-order terms.
+    const double epsilon = numeric_limits<double>::epsilon();
+    averages.resize(rowWindows.size() * n);
+    tolerances.resize(rowWindows.size() * n);
+    for (size_t row = 0; row < rowWindows.size(); row++) {
+        int window = rowWindows[row];
+        double *average = averages.data() + row * n;
+        double *tolerance = tolerances.data() + row * n;
+        for (int day = 0; day < n; day++) {
+            int index = this->firstIndex + day;
+            int end = index + 1 - baseIndex;
+            int start = max(index - window + 1, 0) - baseIndex;
+            int count = end - start;
+            average[day] = (prefix[end] - prefix[start]) / count;
+            tolerance[day] = 2.0 * epsilon * (end + count + 2) * magnitude[end] / count;
+        }
+    }
+}
+
+// Same summation order as IndicatorEngine's tables and Strategy::calculateMovingAverage
+double SimpleAverageTable::referenceAverage(int index, int window) const
+{
+    int startIdx = max(index - window + 1, 0);
+    double sum = 0.0;
+    for (int i = startIdx; i <= index; i++) {
+        sum += prices[i];
+    }
+    return sum / (index - startIdx + 1);
+}
+
+int SimpleAverageTable::getFirstIndex() const
+{
+    return firstIndex;
+}
+
+int SimpleAverageTable::getEndIndex() const
+{
+    return endIndex;
+}
+
+bool SimpleAverageTable::hasWindow(int window) const
+{
+    return window > 0 && window < static_cast<int>(rowOf.size()) && rowOf[window] >= 0 && !averages.empty();
+}
+
+const double *SimpleAverageTable::averageSeries(int window) const
+{
+    return hasWindow(window) ? averages.data() + static_cast<size_t>(rowOf[window]) * days() : nullptr;
+}
+
+int SimpleAverageTable::crossoverSignals(int fastWindow, int slowWindow, int startDay, int endDay, unsigned char *signals) const
+{
+    if (!hasWindow(fastWindow) || !hasWindow(slowWindow)) {
+        return 0;
+    }
+    startDay = max(startDay, firstIndex);
+    endDay = min(endDay, endIndex);
+    int n = endDay - startDay;
+    if (n <= 0) {
+        return 0;
+    }
+    size_t offset = startDay - firstIndex;
+    const double *fast = averages.data() + static_cast<size_t>(rowOf[fastWindow]) * days() + offset;
+    const double *slow = averages.data() + static_cast<size_t>(rowOf[slowWindow]) * days() + offset;
+    const double *fastTolerance = tolerances.data() + static_cast<size_t>(rowOf[fastWindow]) * days() + offset;
+    const double *slowTolerance = tolerances.data() + static_cast<size_t>(rowOf[slowWindow]) * days() + offset;
+
+    // Branch-free, so the compiler vectorizes it; a NaN difference counts as close
+    int close = 0;
+    for (int day = 0; day < n; day++) {
+        double difference = fast[day] - slow[day];
+        signals[day] = difference > 0.0;
+        close += !(fabs(difference) > fastTolerance[day] + slowTolerance[day]);
+    }
+    if (close == 0) {
+        return 0;
+    }
+
+    int recomputed = 0;
+    for (int day = 0; day < n; day++) {
+        double difference = fast[day] - slow[day];
+        if (!(fabs(difference) > fastTolerance[day] + slowTolerance[day])) {
+            signals[day] = referenceAverage(startDay + day, fastWindow) > referenceAverage(startDay + day, slowWindow);
+            recomputed++;
+        }
+    }
+    return recomputed;
+}
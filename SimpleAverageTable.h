@@ -0,0 +1,53 @@
+#ifndef SIMPLE_AVERAGE_TABLE_H
+#define SIMPLE_AVERAGE_TABLE_H
+
+#include <vector>
+#include "PriceSeries.h"
+
+using namespace std;
+
+// Simple moving averages for a whole set of windows over days [firstIndex, endIndex),
+// stored as one [window][day] table and built from a single prefix-sum pass, so each entry
+// costs O(1) whatever its window. Built for trend-following grids, where every (short,
+// long) pair reuses the same few windows.
+//
+// Prefix-sum averages round differently from the oldest-to-newest sums IndicatorEngine
+// and Strategy::calculateMovingAverage use, so entries may differ from them in the last
+// bits. Every entry therefore carries an error bound, and crossoverSignals() recomputes
+// the two averages the reference way on the rare days whose comparison falls within the
+// bounds: signals always match comparing the reference averages exactly. The prefix sums
+// start at the first price the table needs, so the bounds grow with the span of the
+// table, not with the position in the series.
+class SimpleAverageTable
+{
+private:
+    PriceView prices;
+    int firstIndex;
+    int endIndex;
+    int baseIndex;          // first price any window reaches back to
+    vector<int> rowOf;      // row of each window, -1 if not in the table
+    vector<double> averages;   // [row][day - firstIndex]
+    vector<double> tolerances; // [row][day - firstIndex], bound on |average - reference average|
+
+    int days() const { return endIndex - firstIndex; }
+    double referenceAverage(int index, int window) const;
+
+public:
+    // Non-positive windows are ignored; duplicates share a row
+    SimpleAverageTable(PriceView prices, int firstIndex, int endIndex, const vector<int> &windows);
+
+    int getFirstIndex() const;
+    int getEndIndex() const;
+    bool hasWindow(int window) const;
+
+    // Row of averages for window, entry index - getFirstIndex() holding day index; nullptr
+    // if the window is not in the table. Close to, not bit-identical with, the reference.
+    const double *averageSeries(int window) const;
+
+    // signals[day - startDay] = 1 if the simple average over fastWindow is above the one
+    // over slowWindow on that day, else 0, for days [startDay, endDay) inside the table.
+    // Both windows must be in the table. Returns the number of days recomputed exactly.
+    int crossoverSignals(int fastWindow, int slowWindow, int startDay, int endDay, unsigned char *signals) const;
+};
+
+#endif // SIMPLE_AVERAGE_TABLE_H
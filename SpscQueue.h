@@ -0,0 +1,77 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread. The
+// producer only writes tail and the consumer only writes head, each published with a
+// release store and read with an acquire load, so neither side ever waits on a lock. A full
+// queue makes tryPush fail, which is how a fast producer is held back (backpressure).
+template <class T>
+class SpscQueue
+{
+private:
+    static const size_t CACHE_LINE = 64;
+
+    vector<T> slots;
+    size_t mask;
+    // Padding keeps the two indices, written by different threads, on separate cache lines
+    char padBefore[CACHE_LINE];
+    atomic<size_t> head; // next slot to pop, written by the consumer
+    char padBetween[CACHE_LINE];
+    atomic<size_t> tail; // next slot to push, written by the producer
+    char padAfter[CACHE_LINE];
+
+    static size_t roundUpToPowerOfTwo(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+public:
+    // Holds at least capacity items (rounded up to a power of two)
+    explicit SpscQueue(size_t capacity)
+    : slots(roundUpToPowerOfTwo(capacity)), mask(slots.size() - 1), head(0), tail(0) {}
+
+    size_t capacity() const { return slots.size(); }
+
+    // Producer side; false if the queue is full
+    bool tryPush(const T &item)
+    {
+        size_t position = tail.load(memory_order_relaxed);
+        if (position - head.load(memory_order_acquire) == slots.size()) {
+            return false;
+        }
+        slots[position & mask] = item;
+        tail.store(position + 1, memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false if the queue is empty
+    bool tryPop(T &item)
+    {
+        size_t position = head.load(memory_order_relaxed);
+        if (position == tail.load(memory_order_acquire)) {
+            return false;
+        }
+        item = slots[position & mask];
+        head.store(position + 1, memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is active
+    bool empty() const { return head.load(memory_order_acquire) == tail.load(memory_order_acquire); }
+
+    // Prevent copying
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+};
+
+#endif // SPSC_QUEUE_H
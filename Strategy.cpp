@@ -1,16 +1,19 @@
 #include "Strategy.h"
+#include "Instrumentation.h"
+#include "StrategyKernels.h"
 #include <iostream>
 
 Strategy::Strategy()
-: name(""){  
+: name(""), shortcutOwner(nullptr){  
 }
 
 Strategy::Strategy(const string &name)
-: name(name){
+: name(name), shortcutOwner(nullptr){
 }
 
 double Strategy::calculateMovingAverage(Market *market, int index, int window) const
 {
+    INSTRUMENT_SCOPE("Strategy::calculateMovingAverage");
     
     if (market == nullptr) {
         return 0.0;
@@ -20,18 +23,104 @@ double Strategy::calculateMovingAverage(Market *market, int index, int window) c
         return market->getPrice(max(0, index));
     }
 
+    PriceView prices = market->getPriceView();
     double sum = 0.0;
     int startIdx = max(index - window + 1, 0);
-    int count = 0;
-    
-    for (int i = startIdx; i <= index; i++) {
-        sum += market->getPrice(i);
-        count++;
+    int lastIdx = min(index, prices.size() - 1);
+    int count = index - startIdx + 1;
+
+    // Days past the end of the series count as 0.0, matching getPrice()
+    for (int i = startIdx; i <= lastIdx; i++) {
+        sum += prices[i];
     }
     
     return count > 0 ? sum / count : market->getPrice(index);
 }
 
+void Strategy::registerIndicators(IndicatorEngine &indicators) const
+{
+    (void)indicators;
+}
+
+double Strategy::calculateMovingAverage(IndicatorEngine &indicators, int index, int window) const
+{
+    return indicators.simpleMovingAverage(index, window);
+}
+
+Action Strategy::decideAction(IndicatorEngine &indicators, int index, double currentHolding) const
+{
+    if (!usesShortcuts()) {
+        return decideAction(indicators.getMarket(), index, currentHolding);
+    }
+    return decideFromIndicators(indicators, index, currentHolding);
+}
+
+bool Strategy::describeRule(IndicatorEngine &indicators, SignalRule &rule) const
+{
+    return usesShortcuts() && buildRule(indicators, rule);
+}
+
+bool Strategy::describeLiveRule(LiveIndicators &indicators, SignalRule &rule) const
+{
+    return usesShortcuts() && buildLiveRule(indicators, rule);
+}
+
+void Strategy::decideActions(IndicatorEngine &indicators, int startDay, int endDay, Action *actions) const
+{
+    const double *prices = indicators.getPrices().data();
+    SignalRule rule;
+    bool inRange = startDay >= indicators.getFirstIndex() && endDay <= indicators.getEndIndex();
+    if (inRange && describeRule(indicators, rule)) {
+        decideRuleActions(rule, prices, indicators.getFirstIndex(), startDay, endDay, actions);
+        return;
+    }
+    DecideActionKernel(*this, indicators).decideActions(prices, startDay, endDay, actions);
+}
+
+StrategyStats Strategy::backtest(IndicatorEngine &indicators, int startDay, int endDay) const
+{
+    const double *prices = indicators.getPrices().data();
+    int firstIndex = indicators.getFirstIndex();
+
+    SignalRule rule;
+    bool inRange = startDay >= firstIndex && endDay <= indicators.getEndIndex();
+    if (inRange && describeRule(indicators, rule)) {
+        return backtestRule(rule, prices, firstIndex, startDay, endDay);
+    }
+    vector<Action> actions(max(endDay - startDay, 0));
+    decideActions(indicators, startDay, endDay, actions.data());
+    return ActionBufferKernel(actions.data(), startDay).backtest(prices, startDay, endDay);
+}
+
+bool Strategy::usesShortcuts() const
+{
+    return shortcutOwner == nullptr || typeid(*this) == *shortcutOwner;
+}
+
+Action Strategy::decideFromIndicators(IndicatorEngine &indicators, int index, double currentHolding) const
+{
+    return decideAction(indicators.getMarket(), index, currentHolding);
+}
+
+bool Strategy::buildRule(IndicatorEngine &indicators, SignalRule &rule) const
+{
+    (void)indicators;
+    (void)rule;
+    return false;
+}
+
+bool Strategy::buildLiveRule(LiveIndicators &indicators, SignalRule &rule) const
+{
+    (void)indicators;
+    (void)rule;
+    return false;
+}
+
+void Strategy::setShortcutOwner(const type_info &owner)
+{
+    shortcutOwner = &owner;
+}
+
 string Strategy::getName() const
 {
     return name;
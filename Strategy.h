@@ -2,10 +2,15 @@
 #define STRATEGY_H
 
 #include <string>
+#include <typeinfo>
 #include "Market.h"
+#include "IndicatorEngine.h"
+#include "Leaderboard.h"
 
 using namespace std;
 
+class LiveIndicators;
+
 const int EVALUATION_WINDOW = 100;
 
 enum Action
@@ -15,11 +20,37 @@ enum Action
         HOLD
     };
 
+// A strategy's daily decision reduced to comparisons on precomputed indicator series, so
+// the fused backtest can evaluate many strategies per day without calling into each one.
+// Series are IndicatorEngine tables, indexed by day - IndicatorEngine::getFirstIndex(), or
+// for live rules single LiveIndicators cells holding the latest day's value.
+struct SignalRule
+{
+    enum Kind
+    {
+        // Hold while fast[day] > slow[day]: BUY when that starts, SELL when it stops
+        CROSSOVER,
+        // BUY when price < average[day] * lowerFactor, SELL when price > average[day] * upperFactor
+        BAND
+    };
+
+    Kind kind;
+    const double *fast;
+    const double *slow;
+    const double *average;
+    double lowerFactor;
+    double upperFactor;
+
+    SignalRule() : kind(CROSSOVER), fast(nullptr), slow(nullptr), average(nullptr), lowerFactor(0.0), upperFactor(0.0) {}
+};
+
 
 class Strategy
 {
 private:
     string name;
+    // Type whose indicator and rule hooks these are, or null if they are the object's own
+    const type_info *shortcutOwner;
     // TODO: fill out this part if needed
     
 
@@ -40,6 +71,51 @@ public:
     string getName() const;
     virtual double calculateMovingAverage(Market *market, int index, int window) const;
     virtual Action decideAction(Market *market,int index, double currentHolding) const =0;
+
+    // Cached-indicator path used by TradingBot. Defaults fall back to the Market-based
+    // methods, so strategies that only implement those keep working unchanged.
+    virtual void registerIndicators(IndicatorEngine &indicators) const;
+    virtual double calculateMovingAverage(IndicatorEngine &indicators, int index, int window) const;
+    // decideFromIndicators when usesShortcuts(), otherwise decideAction(market, ...)
+    Action decideAction(IndicatorEngine &indicators, int index, double currentHolding) const;
+
+    // Fills rule with an exact equivalent of decideAction(indicators, ...) over the engine's
+    // range and returns true, or returns false to be evaluated through decideAction instead.
+    // The rule comes from buildRule and is only asked for when usesShortcuts().
+    bool describeRule(IndicatorEngine &indicators, SignalRule &rule) const;
+
+    // Same rule over a live feed's incremental indicators, for LiveSession; false if the
+    // strategy cannot be decided from them
+    bool describeLiveRule(LiveIndicators &indicators, SignalRule &rule) const;
+
+    // Fills actions[day - startDay] with the decision for every day of [startDay, endDay)
+    // in the engine's range, for a position that starts flat and then follows those
+    // decisions as a backtest would. The default decides the whole range in one loop over
+    // describeRule's tables, or calls decideAction once per day if there is no rule.
+    virtual void decideActions(IndicatorEngine &indicators, int startDay, int endDay, Action *actions) const;
+
+    // Backtests days [startDay, endDay) of the engine's prices. The default runs the
+    // compile-time kernel matching describeRule (see StrategyKernels.h), so the per-day
+    // loop has no virtual calls, and otherwise replays one decideActions call. A strategy
+    // with a rule is therefore never asked for decideActions here: the kernel makes the
+    // same decisions while tracking the position, without filling a buffer first.
+    virtual StrategyStats backtest(IndicatorEngine &indicators, int startDay, int endDay) const;
+
+    // Whether decideFromIndicators, buildRule and buildLiveRule may stand in for the
+    // Market-based methods. False for a subclass of a built-in strategy: it may override
+    // the Market-based methods, which the built-in shortcuts would not see.
+    bool usesShortcuts() const;
+
+protected:
+    // Hooks behind decideAction(IndicatorEngine &, ...), describeRule and describeLiveRule.
+    // The defaults decide through decideAction(market, ...) and describe no rule.
+    virtual Action decideFromIndicators(IndicatorEngine &indicators, int index, double currentHolding) const;
+    virtual bool buildRule(IndicatorEngine &indicators, SignalRule &rule) const;
+    virtual bool buildLiveRule(LiveIndicators &indicators, SignalRule &rule) const;
+
+    // Called by a constructor whose hooks only match its own Market-based methods, so they
+    // are used for objects of exactly that type and not for subclasses
+    void setShortcutOwner(const type_info &owner);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "StrategyArena.h"
+#include <algorithm>
+
+const size_t StrategyArena::DEFAULT_BLOCK_BYTES;
+
+StrategyArena::StrategyArena(size_t blockBytes)
+: lastPool(nullptr), lastType(typeid(void)), blockBytes(blockBytes){
+}
+
+StrategyArena::~StrategyArena()
+{
+    clear();
+}
+
+StrategyArena::Pool &StrategyArena::poolFor(const type_index &type, size_t objectSize, void (*destroy)(void *))
+{
+    if (lastPool != nullptr && lastType == type) {
+        return *lastPool;
+    }
+    unique_ptr<Pool> &pool = pools[type];
+    if (!pool) {
+        pool.reset(new Pool());
+        // Round up so every slot keeps the block's max_align_t alignment
+        pool->objectSize = (objectSize + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t);
+        pool->objectsPerBlock = max<size_t>(1, blockBytes / pool->objectSize);
+        pool->destroy = destroy;
+        pool->usedInLastBlock = 0;
+        pool->objectCount = 0;
+        poolOrder.push_back(pool.get());
+    }
+    lastPool = pool.get();
+    lastType = type;
+    return *pool;
+}
+
+void *StrategyArena::allocate(Pool &pool)
+{
+    if (pool.blocks.empty() || pool.usedInLastBlock == pool.objectsPerBlock) {
+        pool.blocks.push_back(static_cast<char *>(::operator new(pool.objectSize * pool.objectsPerBlock)));
+        pool.usedInLastBlock = 0;
+    }
+    return pool.blocks.back() + pool.usedInLastBlock * pool.objectSize;
+}
+
+// Called once the constructor has returned, so a throwing constructor leaves no object behind
+void StrategyArena::commit(Pool &pool)
+{
+    pool.usedInLastBlock++;
+    pool.objectCount++;
+}
+
+void StrategyArena::clear()
+{
+    for (Pool *pool : poolOrder) {
+        size_t remaining = pool->objectCount;
+        for (char *block : pool->blocks) {
+            size_t inBlock = min(remaining, pool->objectsPerBlock);
+            for (size_t k = 0; k < inBlock; k++) {
+                pool->destroy(block + k * pool->objectSize);
+            }
+            remaining -= inBlock;
+            ::operator delete(block);
+        }
+    }
+    pools.clear();
+    poolOrder.clear();
+    lastPool = nullptr;
+    lastType = type_index(typeid(void));
+}
+
+size_t StrategyArena::getObjectCount() const
+{
+    size_t count = 0;
+    for (const Pool *pool : poolOrder) {
+        count += pool->objectCount;
+    }
+    return count;
+}
+
+size_t StrategyArena::getPoolCount() const
+{
+    return poolOrder.size();
+}
+
+size_t StrategyArena::getBlockCount() const
+{
+    size_t count = 0;
+    for (const Pool *pool : poolOrder) {
+        count += pool->blocks.size();
+    }
+    return count;
+}
@@ -0,0 +1,79 @@
+#ifndef STRATEGY_ARENA_H
+#define STRATEGY_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <typeinfo>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Owns objects in contiguous blocks, one pool per concrete type, so strategies of the same
+// type sit next to each other in creation order and a sweep of a million strategies costs a
+// few thousand allocations instead of a million. Objects are never freed one by one: clear()
+// and the destructor run every destructor and release the blocks in bulk. Not thread-safe.
+class StrategyArena
+{
+private:
+    struct Pool
+    {
+        size_t objectSize;
+        size_t objectsPerBlock;
+        void (*destroy)(void *object);
+        vector<char *> blocks;
+        size_t usedInLastBlock; // objects constructed in blocks.back()
+        size_t objectCount;
+    };
+
+    unordered_map<type_index, unique_ptr<Pool>> pools;
+    vector<Pool *> poolOrder; // creation order of the pools, for a deterministic teardown
+    Pool *lastPool;           // most recently used, saves the hash lookup on runs of one type
+    type_index lastType;
+    size_t blockBytes;
+
+    template <class T>
+    static void destroyObject(void *object)
+    {
+        static_cast<T *>(object)->~T();
+    }
+
+    Pool &poolFor(const type_index &type, size_t objectSize, void (*destroy)(void *));
+    void *allocate(Pool &pool);
+    void commit(Pool &pool);
+
+public:
+    static const size_t DEFAULT_BLOCK_BYTES = 64 * 1024;
+
+    // Blocks hold blockBytes, or one object if that is larger
+    explicit StrategyArena(size_t blockBytes = DEFAULT_BLOCK_BYTES);
+    ~StrategyArena();
+
+    // Constructs a T in T's pool; the arena owns it until clear() or destruction
+    template <class T, class... Args>
+    T *create(Args &&...args)
+    {
+        static_assert(alignof(T) <= alignof(max_align_t), "StrategyArena blocks are only max_align_t aligned");
+        Pool &pool = poolFor(type_index(typeid(T)), sizeof(T), &destroyObject<T>);
+        void *slot = allocate(pool);
+        T *object = new (slot) T(std::forward<Args>(args)...);
+        commit(pool);
+        return object;
+    }
+
+    // Destroys every object and frees every block
+    void clear();
+
+    size_t getObjectCount() const;
+    size_t getPoolCount() const;
+    size_t getBlockCount() const;
+
+    // Prevent copying
+    StrategyArena(const StrategyArena &) = delete;
+    StrategyArena &operator=(const StrategyArena &) = delete;
+};
+
+#endif // STRATEGY_ARENA_H
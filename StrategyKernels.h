@@ -0,0 +1,240 @@
+#ifndef STRATEGY_KERNELS_H
+#define STRATEGY_KERNELS_H
+
+#include <algorithm>
+#include "IndicatorEngine.h"
+#include "Leaderboard.h"
+#include "Strategy.h"
+
+using namespace std;
+
+// Compile-time specialized backtest loops. Each kernel supplies an inline decideDay() and
+// StrategyKernel<Kernel>::backtest() instantiates the day loop around it, so a whole
+// backtest runs over a raw price span with no virtual or bounds-checked call per day.
+// Strategy::backtest is the type-erased entry point that picks the kernel for a strategy.
+
+// Position and P&L bookkeeping for one strategy, shared by every kernel
+class PositionTracker
+{
+private:
+    StrategyStats stats;
+    double profit;
+    double currentHolding;
+    double buyPrice;
+    double peakEquity;
+
+public:
+    PositionTracker() : profit(0.0), currentHolding(0.0), buyPrice(0.0), peakEquity(0.0) {}
+
+    double getHolding() const { return currentHolding; }
+
+    void apply(Action action, double price)
+    {
+        if (action == BUY && currentHolding == 0.0) {
+            buyPrice = price;
+            currentHolding = 1.0;
+        } else if (action == SELL && currentHolding == 1.0) {
+            double tradeProfit = price - buyPrice;
+            profit += tradeProfit;
+            currentHolding = 0.0;
+            stats.tradeCount++;
+            stats.winningTrades += tradeProfit > 0.0 ? 1 : 0;
+        }
+
+        double equity = profit;
+        if (currentHolding == 1.0) {
+            equity += price - buyPrice;
+            stats.exposureDays++;
+        }
+        peakEquity = max(peakEquity, equity);
+        stats.maxDrawdown = max(stats.maxDrawdown, peakEquity - equity);
+    }
+
+    // Closes any open position at lastPrice
+    StrategyStats finish(double lastPrice)
+    {
+        if (currentHolding == 1.0) {
+            double tradeProfit = lastPrice - buyPrice;
+            profit += tradeProfit;
+            stats.tradeCount++;
+            stats.winningTrades += tradeProfit > 0.0 ? 1 : 0;
+            currentHolding = 0.0;
+        }
+        stats.profit = profit;
+        return stats;
+    }
+};
+
+template <class Kernel>
+class StrategyKernel
+{
+public:
+    // Backtests days [startDay, endDay) of prices, closing any position on the last day
+    StrategyStats backtest(const double *prices, int startDay, int endDay) const
+    {
+        const Kernel &kernel = static_cast<const Kernel &>(*this);
+        PositionTracker position;
+        if (endDay <= startDay) {
+            return position.finish(0.0);
+        }
+        for (int day = startDay; day < endDay; day++) {
+            position.apply(kernel.decideDay(prices, day, position.getHolding()), prices[day]);
+        }
+        return position.finish(prices[endDay - 1]);
+    }
+
+    // Decisions for days [startDay, endDay) into actions[day - startDay], for a position that
+    // starts flat and follows them the way PositionTracker does (see Strategy::decideActions)
+    void decideActions(const double *prices, int startDay, int endDay, Action *actions) const
+    {
+        const Kernel &kernel = static_cast<const Kernel &>(*this);
+        double holding = 0.0;
+        for (int day = startDay; day < endDay; day++) {
+            Action action = kernel.decideDay(prices, day, holding);
+            actions[day - startDay] = action;
+            if (action == BUY && holding == 0.0) {
+                holding = 1.0;
+            } else if (action == SELL && holding == 1.0) {
+                holding = 0.0;
+            }
+        }
+    }
+};
+
+// Trend following over two moving-average series, simple (TrendFollowingStrategy) or
+// weighted (WeightedTrendFollowingStrategy); the series start at day firstIndex
+class TrendFollowingKernel : public StrategyKernel<TrendFollowingKernel>
+{
+private:
+    const double *shortAverage;
+    const double *longAverage;
+    int firstIndex;
+
+public:
+    TrendFollowingKernel(const double *shortAverage, const double *longAverage, int firstIndex)
+    : shortAverage(shortAverage), longAverage(longAverage), firstIndex(firstIndex) {}
+
+    Action decideDay(const double *prices, int day, double currentHolding) const
+    {
+        (void)prices;
+        return decideTrend(shortAverage[day - firstIndex] > longAverage[day - firstIndex], currentHolding);
+    }
+
+    // The trend-following rule itself, shared by every path that decides it
+    static Action decideTrend(bool isUptrend, double currentHolding)
+    {
+        if (isUptrend && currentHolding == 0.0) {
+            return BUY;
+        }
+        if (!isUptrend && currentHolding == 1.0) {
+            return SELL;
+        }
+        return HOLD;
+    }
+};
+
+// Trend following from precomputed crossover signals (1 while the short average is above
+// the long one, see SimpleAverageTable::crossoverSignals) that start at day firstIndex
+class CrossoverSignalKernel : public StrategyKernel<CrossoverSignalKernel>
+{
+private:
+    const unsigned char *signals;
+    int firstIndex;
+
+public:
+    CrossoverSignalKernel(const unsigned char *signals, int firstIndex) : signals(signals), firstIndex(firstIndex) {}
+
+    Action decideDay(const double *prices, int day, double currentHolding) const
+    {
+        (void)prices;
+        return TrendFollowingKernel::decideTrend(signals[day - firstIndex] != 0, currentHolding);
+    }
+};
+
+// Mean reversion around one moving-average series that starts at day firstIndex
+class MeanReversionKernel : public StrategyKernel<MeanReversionKernel>
+{
+private:
+    const double *average;
+    int firstIndex;
+    double lowerFactor;
+    double upperFactor;
+
+public:
+    MeanReversionKernel(const double *average, int firstIndex, double lowerFactor, double upperFactor)
+    : average(average), firstIndex(firstIndex), lowerFactor(lowerFactor), upperFactor(upperFactor) {}
+
+    Action decideDay(const double *prices, int day, double currentHolding) const
+    {
+        return decideBand(prices[day], average[day - firstIndex], lowerFactor, upperFactor, currentHolding);
+    }
+
+    // The mean-reversion rule itself, shared by every path that decides it
+    static Action decideBand(double price, double movingAvg, double lowerFactor, double upperFactor, double currentHolding)
+    {
+        if (currentHolding == 0.0) {
+            return price < movingAvg * lowerFactor ? BUY : HOLD;
+        }
+        if (currentHolding == 1.0) {
+            return price > movingAvg * upperFactor ? SELL : HOLD;
+        }
+        return HOLD;
+    }
+};
+
+// Runs the kernel a SignalRule describes; rule series start at day firstIndex
+inline StrategyStats backtestRule(const SignalRule &rule, const double *prices, int firstIndex, int startDay, int endDay)
+{
+    if (rule.kind == SignalRule::BAND) {
+        return MeanReversionKernel(rule.average, firstIndex, rule.lowerFactor, rule.upperFactor).backtest(prices, startDay, endDay);
+    }
+    return TrendFollowingKernel(rule.fast, rule.slow, firstIndex).backtest(prices, startDay, endDay);
+}
+
+// Same decisions into a buffer, for Strategy::decideActions
+inline void decideRuleActions(const SignalRule &rule, const double *prices, int firstIndex, int startDay, int endDay, Action *actions)
+{
+    if (rule.kind == SignalRule::BAND) {
+        MeanReversionKernel(rule.average, firstIndex, rule.lowerFactor, rule.upperFactor).decideActions(prices, startDay, endDay, actions);
+    } else {
+        TrendFollowingKernel(rule.fast, rule.slow, firstIndex).decideActions(prices, startDay, endDay, actions);
+    }
+}
+
+// Replays decisions filled in by Strategy::decideActions, actions[day - firstIndex]
+class ActionBufferKernel : public StrategyKernel<ActionBufferKernel>
+{
+private:
+    const Action *actions;
+    int firstIndex;
+
+public:
+    ActionBufferKernel(const Action *actions, int firstIndex) : actions(actions), firstIndex(firstIndex) {}
+
+    Action decideDay(const double *prices, int day, double currentHolding) const
+    {
+        (void)prices;
+        (void)currentHolding;
+        return actions[day - firstIndex];
+    }
+};
+
+// Fallback for strategies without a SignalRule: one virtual decideAction call per day
+class DecideActionKernel : public StrategyKernel<DecideActionKernel>
+{
+private:
+    const Strategy &strategy;
+    IndicatorEngine &indicators;
+
+public:
+    DecideActionKernel(const Strategy &strategy, IndicatorEngine &indicators)
+    : strategy(strategy), indicators(indicators) {}
+
+    Action decideDay(const double *prices, int day, double currentHolding) const
+    {
+        (void)prices;
+        return strategy.decideAction(indicators, day, currentHolding);
+    }
+};
+
+#endif // STRATEGY_KERNELS_H
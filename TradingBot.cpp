@@ -1,8 +1,56 @@
 #include "TradingBot.h"
+#include "Instrumentation.h"
+#include "StrategyKernels.h"
+#include "RuleTrajectory.h"
+#include "MeanReversionBatch.h"
+#include "SignalHistory.h"
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <map>
+
+// Largest group of bands one MeanReversionBatch runs, so a grid with few windows still
+// spreads over the threads
+static const int BAND_BATCH_SIZE = 32;
+
+// Groups the described BAND rules by their average series, in order, into batches of at
+// most BAND_BATCH_SIZE; batchOf[k] is the batch of rule k, -1 if it runs on its own
+static void groupBands(const vector<SignalRule> &rules, const vector<char> &described, vector<vector<int>> &batches, vector<int> &batchOf)
+{
+    batches.clear();
+    batchOf.assign(rules.size(), -1);
+    map<const double *, int> openBatch;
+    for (size_t k = 0; k < rules.size(); k++) {
+        if (!described[k] || rules[k].kind != SignalRule::BAND) {
+            continue;
+        }
+        map<const double *, int>::iterator open = openBatch.find(rules[k].average);
+        if (open == openBatch.end() || static_cast<int>(batches[open->second].size()) == BAND_BATCH_SIZE) {
+            openBatch[rules[k].average] = static_cast<int>(batches.size());
+            batches.push_back(vector<int>());
+        }
+        int batch = openBatch[rules[k].average];
+        batches[batch].push_back(static_cast<int>(k));
+        batchOf[k] = batch;
+    }
+}
+
+// Backtests one batch from groupBands, writing each rule's stats to stats[k]
+static void runBandBatch(const vector<int> &batch, const vector<SignalRule> &rules, const double *prices, int firstIndex, int startDay, int endDay, vector<StrategyStats> &stats)
+{
+    MeanReversionBatch bands(prices, rules[batch[0]].average, firstIndex);
+    for (size_t b = 0; b < batch.size(); b++) {
+        bands.addBand(rules[batch[b]].lowerFactor, rules[batch[b]].upperFactor);
+    }
+    vector<StrategyStats> batchResults;
+    bands.run(startDay, endDay, batchResults);
+    for (size_t b = 0; b < batch.size(); b++) {
+        stats[batch[b]] = batchResults[b];
+    }
+}
 
 TradingBot::TradingBot(Market *market, int initialCapacity)
-: market(market) , availableStrategies(new Strategy*[initialCapacity]),strategyCount(0),strategyCapacity(initialCapacity)
+: market(market) , availableStrategies(new Strategy*[initialCapacity]),strategyCount(0),strategyCapacity(initialCapacity), threadCount(1), evaluationMode(PER_STRATEGY)
 {
     for(int i =0;i< strategyCapacity;i++){
         availableStrategies[i] =nullptr;
@@ -11,8 +59,11 @@ TradingBot::TradingBot(Market *market, int initialCapacity)
 
 TradingBot::~TradingBot()
 {
-    for(int i =0;i< strategyCapacity;i++){
-        delete availableStrategies[i];
+    // Arena strategies are destroyed together when the arena member goes
+    for(int i =0;i< strategyCount;i++){
+        if (!arenaOwned[i]) {
+            delete availableStrategies[i];
+        }
         availableStrategies[i] =nullptr;
     }
     delete [] availableStrategies;
@@ -25,10 +76,14 @@ void TradingBot::addStrategy(Strategy *strategy)
     if (strategy == nullptr) {
         return;
     }
+    appendStrategy(strategy, false);
+}
 
+void TradingBot::appendStrategy(Strategy *strategy, bool inArena)
+{
     if(strategyCount==strategyCapacity){
-        Strategy **newAvailableStartegies = new Strategy*[strategyCapacity*2];
-        int newStartegyCapacity = strategyCapacity*2;
+        int newStartegyCapacity = max(strategyCapacity*2, 1);
+        Strategy **newAvailableStartegies = new Strategy*[newStartegyCapacity];
         for(int i =0;i<strategyCount;i++){
             newAvailableStartegies[i] = availableStrategies[i];
         }
@@ -40,53 +95,613 @@ void TradingBot::addStrategy(Strategy *strategy)
         availableStrategies = newAvailableStartegies;
     }
     availableStrategies[strategyCount++] =strategy;
+    arenaOwned.push_back(inArena ? 1 : 0);
+}
+
+void TradingBot::addStrategies(const ParameterSweep &parameters)
+{
+    for (long long id = 0; id < parameters.size(); id++) {
+        appendStrategy(parameters.createStrategy(id, arena), true);
+    }
+}
+
+int TradingBot::getStrategyCount() const
+{
+    return strategyCount;
+}
+
+Strategy *TradingBot::getStrategy(int index) const
+{
+    if (index < 0 || index >= strategyCount) {
+        return nullptr;
+    }
+    return availableStrategies[index];
+}
+
+void TradingBot::setThreadCount(int threads)
+{
+    int resolved = threads > 0 ? threads : WorkStealingPool::defaultThreadCount();
+    if (resolved != threadCount) {
+        pool.reset();
+    }
+    threadCount = resolved;
+}
+
+int TradingBot::getThreadCount() const
+{
+    return threadCount;
+}
+
+void TradingBot::setEvaluationMode(EvaluationMode mode)
+{
+    evaluationMode = mode;
+}
+
+EvaluationMode TradingBot::getEvaluationMode() const
+{
+    return evaluationMode;
 }
 
 SimulationResult TradingBot::runSimulation()
 {
+    return simulate(nullptr);
+}
+
+SimulationResult TradingBot::runSimulation(Leaderboard &leaderboard)
+{
+    return simulate(&leaderboard);
+}
+
+// The last EVALUATION_WINDOW + 1 days of the market, or all of them if it is shorter
+bool TradingBot::evaluationRange(int &startDay, int &endDay) const
+{
+    if (market == nullptr || market->getNumTradingDays() <= 1) {
+        return false;
+    }
+
+    PriceView prices = market->getPriceView();
+    endDay = min(market->getNumTradingDays(), prices.size());
+    if (endDay <= 1) {
+        return false;
+    }
+    startDay = max(endDay-(EVALUATION_WINDOW+1), 0);
+    return true;
+}
+
+SimulationResult TradingBot::simulate(Leaderboard *leaderboard)
+{
+    INSTRUMENT_SCOPE("TradingBot::runSimulation");
     SimulationResult simRes;
 
-    if (market == nullptr || strategyCount == 0 || market->getNumTradingDays() <= 1) {
+    int startDay, numDays;
+    if (strategyCount == 0 || !evaluationRange(startDay, numDays)) {
         return simRes;
     }
+    INSTRUMENT_ITEMS("strategies", strategyCount);
+    INSTRUMENT_ITEMS("days scanned", static_cast<long long>(strategyCount) * (numDays - startDay));
+
+    // Shared by every strategy: each moving-average window is computed once per market
+    IndicatorEngine indicators(market, startDay, numDays);
+    for(int i = 0; i < strategyCount; i++){
+        if (availableStrategies[i] != nullptr) {
+            availableStrategies[i]->registerIndicators(indicators);
+        }
+    }
+    indicators.freeze();
+
+    vector<StrategyStats> results(strategyCount);
+    if (evaluationMode == FUSED) {
+        evaluateFused(indicators, startDay, numDays, results);
+    } else {
+        evaluatePerStrategy(indicators, startDay, numDays, results);
+    }
 
+    // Reduce in insertion order so the winner, ties included, never depends on scheduling
     for(int i = 0; i < strategyCount; i++){
         if (availableStrategies[i] == nullptr) {
             continue;
         }
+        if(results[i].profit > simRes.totalReturn){
+            simRes.bestStrategy = availableStrategies[i];
+            simRes.totalReturn = results[i].profit;
+        }
+        if (leaderboard != nullptr) {
+            leaderboard->record(i, results[i]);
+        }
+    }
+    
+    return simRes;
+}
 
-        double profit = 0;
-        double currentHolding = 0.0;
-        double buyPrice = 0;
-        
-        int startDay = max(market->getNumTradingDays()-101, 0);
-        for(int j = startDay; j < market->getNumTradingDays(); j++){
-            if (j < 0 || j >= market->getNumTradingDays()) {
-                continue;
+void TradingBot::evaluatePerStrategy(IndicatorEngine &indicators, int startDay, int endDay, vector<StrategyStats> &results, bool threaded)
+{
+    INSTRUMENT_SCOPE("TradingBot::evaluatePerStrategy");
+    const double *prices = indicators.getPrices().data();
+    int firstIndex = indicators.getFirstIndex();
+
+    // Mean-reversion strategies sharing an average run together, one batch per work item;
+    // the rest go through Strategy::backtest as before
+    vector<SignalRule> rules(strategyCount);
+    vector<char> described(strategyCount, 0);
+    bool inRange = startDay >= firstIndex && endDay <= indicators.getEndIndex();
+    for(int i = 0; i < strategyCount && inRange; i++){
+        if (availableStrategies[i] != nullptr) {
+            described[i] = availableStrategies[i]->describeRule(indicators, rules[i]);
+        }
+    }
+    vector<vector<int>> batches;
+    vector<int> batchOf;
+    groupBands(rules, described, batches, batchOf);
+
+    int units = strategyCount + static_cast<int>(batches.size());
+    function<void(int)> evaluate = [&](int unit) {
+        if (unit >= strategyCount) {
+            runBandBatch(batches[unit - strategyCount], rules, prices, firstIndex, startDay, endDay, results);
+        } else if (batchOf[unit] < 0 && availableStrategies[unit] != nullptr) {
+            results[unit] = availableStrategies[unit]->backtest(indicators, startDay, endDay);
+        }
+    };
+    if (threaded && threadCount > 1 && units > 1) {
+        if (!pool) {
+            pool.reset(new WorkStealingPool(threadCount));
+        }
+        pool->parallelFor(units, evaluate);
+    } else {
+        for(int unit = 0; unit < units; unit++){
+            evaluate(unit);
+        }
+    }
+}
+
+void TradingBot::evaluateFused(IndicatorEngine &indicators, int startDay, int endDay, vector<StrategyStats> &results)
+{
+    INSTRUMENT_SCOPE("TradingBot::evaluateFused");
+    // Contiguous batches of strategies, one fused pass each
+    int batches = max(1, min(threadCount, strategyCount));
+    function<void(int)> runBatch = [&](int batch) {
+        int first = static_cast<int>(static_cast<long long>(strategyCount) * batch / batches);
+        int last = static_cast<int>(static_cast<long long>(strategyCount) * (batch + 1) / batches);
+        FusedBacktest backtest(indicators, startDay, endDay);
+        vector<int> ids;
+        for(int i = first; i < last; i++){
+            if (availableStrategies[i] != nullptr) {
+                backtest.addStrategy(availableStrategies[i]);
+                ids.push_back(i);
+            }
+        }
+        vector<StrategyStats> batchResults;
+        backtest.run(batchResults);
+        for(size_t k = 0; k < ids.size(); k++){
+            results[ids[k]] = batchResults[k];
+        }
+    };
+
+    if (batches > 1) {
+        if (!pool) {
+            pool.reset(new WorkStealingPool(threadCount));
+        }
+        pool->parallelFor(batches, runBatch);
+    } else {
+        runBatch(0);
+    }
+}
+
+SweepResult TradingBot::runSweep(const ParameterSweep &parameters, int chunkSize)
+{
+    return sweep(parameters, nullptr, chunkSize);
+}
+
+SweepResult TradingBot::runSweep(const ParameterSweep &parameters, Leaderboard &leaderboard, int chunkSize)
+{
+    return sweep(parameters, &leaderboard, chunkSize);
+}
+
+void TradingBot::evaluateCandidates(const ParameterSweep &parameters, IndicatorEngine &indicators, const SimpleAverageTable &averages, const vector<long long> &ids, int startDay, int endDay, vector<StrategyStats> &stats)
+{
+    int count = static_cast<int>(ids.size());
+    const double *prices = indicators.getPrices().data();
+    int firstIndex = indicators.getFirstIndex();
+    vector<SignalRule> rules(count);
+    vector<char> described(count);
+    vector<int> fastWindows(count, 0);
+    vector<int> slowWindows(count, 0);
+    stats.assign(count, StrategyStats());
+
+    // Serial: describing may build tables. Simple trend-following pairs read the shared
+    // average table instead, and combinations without a rule (non-positive windows) are
+    // evaluated here through a temporary strategy.
+    for (int k = 0; k < count; k++) {
+        int grid;
+        long long index;
+        parameters.locate(ids[k], grid, index);
+        const ParameterGrid &parameterGrid = parameters.getGrid(grid);
+        if (parameterGrid.getCrossoverWindows(index, fastWindows[k], slowWindows[k])
+            && averages.hasWindow(fastWindows[k]) && averages.hasWindow(slowWindows[k])) {
+            continue;
+        }
+        fastWindows[k] = 0;
+        described[k] = parameterGrid.describeRule(indicators, index, rules[k]);
+        if (!described[k]) {
+            unique_ptr<Strategy> strategy(parameters.getGrid(grid).createStrategy(index));
+            stats[k] = strategy->backtest(indicators, startDay, endDay);
+        }
+    }
+
+    vector<vector<int>> batches;
+    vector<int> batchOf;
+    groupBands(rules, described, batches, batchOf);
+
+    // Table pointers stay valid while later calls add tables, so this only reads. Crossover
+    // pairs are packed into one bit row each and scored from their entry and exit days.
+    SignalHistory crossovers(startDay, endDay, count);
+    int units = count + static_cast<int>(batches.size());
+    function<void(int)> evaluate = [&](int k) {
+        if (k >= count) {
+            runBandBatch(batches[k - count], rules, prices, firstIndex, startDay, endDay, stats);
+        } else if (batchOf[k] >= 0) {
+            // Evaluated with its batch
+        } else if (fastWindows[k] > 0) {
+            vector<unsigned char> signals(max(endDay - startDay, 0));
+            averages.crossoverSignals(fastWindows[k], slowWindows[k], startDay, endDay, signals.data());
+            crossovers.setRow(k, signals.data());
+            stats[k] = crossovers.backtest(k, prices, startDay, endDay);
+        } else if (described[k]) {
+            stats[k] = backtestRule(rules[k], prices, firstIndex, startDay, endDay);
+        }
+    };
+    if (threadCount > 1 && units > 1) {
+        if (!pool) {
+            pool.reset(new WorkStealingPool(threadCount));
+        }
+        pool->parallelFor(units, evaluate);
+    } else {
+        for (int k = 0; k < units; k++) {
+            evaluate(k);
+        }
+    }
+}
+
+SweepResult TradingBot::sweep(const ParameterSweep &parameters, Leaderboard *leaderboard, int chunkSize)
+{
+    SweepResult result;
+    int startDay, endDay;
+    if (parameters.size() == 0 || !evaluationRange(startDay, endDay)) {
+        return result;
+    }
+    chunkSize = max(chunkSize, 1);
+
+    // Tables are kept per distinct window, so memory grows with the windows, not the grid
+    IndicatorEngine indicators(market, startDay, endDay);
+    SimpleAverageTable averages(indicators.getPrices(), startDay, endDay, parameters.getCrossoverWindows());
+    vector<long long> ids;
+    vector<StrategyStats> stats;
+    for (long long chunkStart = 0; chunkStart < parameters.size(); chunkStart += chunkSize) {
+        int count = static_cast<int>(min<long long>(chunkSize, parameters.size() - chunkStart));
+        ids.resize(count);
+        for (int k = 0; k < count; k++) {
+            ids[k] = chunkStart + k;
+        }
+        evaluateCandidates(parameters, indicators, averages, ids, startDay, endDay, stats);
+
+        for (int k = 0; k < count; k++) {
+            if (stats[k].profit > result.totalReturn) {
+                result.bestId = ids[k];
+                result.totalReturn = stats[k].profit;
             }
-            
-            Action action = availableStrategies[i]->decideAction(market, j, currentHolding);
-            
-            if(action == BUY && currentHolding == 0.0){
-                buyPrice = market->getPrice(j);
-                currentHolding = 1.0;
-            } else if(action == SELL && currentHolding == 1.0){
-                profit += market->getPrice(j) - buyPrice;
-                currentHolding = 0.0;
+            if (leaderboard != nullptr) {
+                leaderboard->record(ids[k], stats[k]);
             }
-            
         }
-        
-        if(currentHolding == 1.0 && market->getNumTradingDays() > 0){
-            profit += market->getPrice(market->getNumTradingDays()-1) - buyPrice;
+        result.evaluated += count;
+    }
+
+    result.bestName = parameters.getName(result.bestId);
+    return result;
+}
+
+// Every sweep id whose parameter indices are within one stride of id's, id included
+static void addNeighbourhood(const ParameterSweep &parameters, long long id, int stride, vector<long long> &ids)
+{
+    int grid;
+    long long index;
+    parameters.locate(id, grid, index);
+    const ParameterGrid &parameterGrid = parameters.getGrid(grid);
+    long long gridStart = id - index;
+    int firstCount = parameterGrid.getFirstRange().size();
+    int secondCount = parameterGrid.getSecondRange().size();
+    int firstIndex = static_cast<int>(index / secondCount);
+    int secondIndex = static_cast<int>(index % secondCount);
+
+    for (int a = firstIndex - stride; a <= firstIndex + stride; a += stride) {
+        for (int b = secondIndex - stride; b <= secondIndex + stride; b += stride) {
+            if (a >= 0 && a < firstCount && b >= 0 && b < secondCount) {
+                ids.push_back(gridStart + static_cast<long long>(a) * secondCount + b);
+            }
         }
-    
-        
-        if(profit > simRes.totalReturn){
-            simRes.bestStrategy = availableStrategies[i];
-            simRes.totalReturn = profit; 
+    }
+}
+
+SweepResult TradingBot::optimize(const ParameterSweep &parameters, const HalvingOptions &options)
+{
+    SweepResult result;
+    int startDay, endDay;
+    if (parameters.size() == 0 || !evaluationRange(startDay, endDay)) {
+        return result;
+    }
+
+    // Strides halve down to 1; the horizon doubles per rung and is the full window on the last
+    vector<int> strides;
+    for (int stride = max(options.coarseStride, 1); ; stride /= 2) {
+        strides.push_back(stride);
+        if (stride == 1) {
+            break;
         }
     }
-    
-    return simRes;
+    int rungs = static_cast<int>(strides.size());
+    int fullDays = endDay - startDay;
+
+    vector<long long> candidates;
+    long long gridStart = 0;
+    for (int grid = 0; grid < parameters.getGridCount(); grid++) {
+        const ParameterGrid &parameterGrid = parameters.getGrid(grid);
+        int secondCount = parameterGrid.getSecondRange().size();
+        for (int a = 0; a < parameterGrid.getFirstRange().size(); a += strides[0]) {
+            for (int b = 0; b < secondCount; b += strides[0]) {
+                candidates.push_back(gridStart + static_cast<long long>(a) * secondCount + b);
+            }
+        }
+        gridStart += parameterGrid.size();
+    }
+
+    IndicatorEngine indicators(market, startDay, endDay);
+    SimpleAverageTable averages(indicators.getPrices(), startDay, endDay, parameters.getCrossoverWindows());
+    vector<StrategyStats> stats;
+    for (int rung = 0; rung < rungs; rung++) {
+        int days = fullDays;
+        if (rung < rungs - 1) {
+            days = max(options.minDays, fullDays >> (rungs - 1 - rung));
+            days = min(days, fullDays);
+        }
+        evaluateCandidates(parameters, indicators, averages, candidates, endDay - days, endDay, stats);
+        result.evaluated += static_cast<long long>(candidates.size());
+
+        // Best first, ties to the lower id, as in a full sweep
+        vector<int> order(candidates.size());
+        for (size_t k = 0; k < order.size(); k++) {
+            order[k] = static_cast<int>(k);
+        }
+        sort(order.begin(), order.end(), [&](int x, int y) {
+            if (stats[x].profit != stats[y].profit) {
+                return stats[x].profit > stats[y].profit;
+            }
+            return candidates[x] < candidates[y];
+        });
+
+        if (rung == rungs - 1) {
+            if (!order.empty()) {
+                result.bestId = candidates[order[0]];
+                result.totalReturn = stats[order[0]].profit;
+            }
+            break;
+        }
+
+        int keep = static_cast<int>(ceil(candidates.size() * options.keepFraction));
+        keep = min(max(keep, options.minSurvivors), static_cast<int>(candidates.size()));
+        vector<long long> next;
+        for (int k = 0; k < keep; k++) {
+            addNeighbourhood(parameters, candidates[order[k]], strides[rung + 1], next);
+        }
+        sort(next.begin(), next.end());
+        next.erase(unique(next.begin(), next.end()), next.end());
+        candidates.swap(next);
+    }
+
+    result.bestName = parameters.getName(result.bestId);
+    return result;
+}
+
+WalkForwardResult TradingBot::runWalkForward(const ParameterSweep &parameters, const WalkForwardOptions &options)
+{
+    WalkForwardResult result;
+    if (market == nullptr || parameters.size() == 0 || options.inSampleDays <= 0 || options.outOfSampleDays <= 0 || options.stepDays <= 0) {
+        return result;
+    }
+    int numDays = min(market->getNumTradingDays(), market->getPriceView().size());
+    vector<int> splitDays;
+    for (int split = options.inSampleDays; split + options.outOfSampleDays <= numDays; split += options.stepDays) {
+        splitDays.push_back(split);
+    }
+    if (splitDays.empty()) {
+        return result;
+    }
+    int steps = static_cast<int>(splitDays.size());
+    if (parameters.size() > numeric_limits<int>::max()) {
+        cerr << "Walk-forward sweep too large: " << parameters.size() << " combinations" << endl;
+        return result;
+    }
+    int count = static_cast<int>(parameters.size());
+
+    // Tables cover the whole series; a day's average does not depend on where a window starts
+    IndicatorEngine indicators(market, 0, numDays);
+    SimpleAverageTable averages(indicators.getPrices(), 0, numDays, parameters.getCrossoverWindows());
+    const double *prices = indicators.getPrices().data();
+    vector<SignalRule> rules(count);
+    vector<char> described(count);
+    vector<int> fastWindows(count, 0);
+    vector<int> slowWindows(count, 0);
+    vector<unique_ptr<Strategy>> fallbacks(count);
+    for (int id = 0; id < count; id++) {
+        int grid;
+        long long index;
+        parameters.locate(id, grid, index);
+        const ParameterGrid &parameterGrid = parameters.getGrid(grid);
+        if (parameterGrid.getCrossoverWindows(index, fastWindows[id], slowWindows[id])
+            && averages.hasWindow(fastWindows[id]) && averages.hasWindow(slowWindows[id])) {
+            continue;
+        }
+        fastWindows[id] = 0;
+        described[id] = parameterGrid.describeRule(indicators, index, rules[id]);
+        if (!described[id]) {
+            fallbacks[id].reset(parameters.getGrid(grid).createStrategy(index));
+            fallbacks[id]->registerIndicators(indicators);
+        }
+    }
+    indicators.freeze();
+
+    // Contiguous batches of combinations, each keeping its own best per step; merging the
+    // batches in order keeps ties with the lower id, as a serial pass would
+    int batches = max(1, min(threadCount, count));
+    vector<vector<double>> batchBest(batches, vector<double>(steps, -numeric_limits<double>::max()));
+    vector<vector<int>> batchBestId(batches, vector<int>(steps, -1));
+    function<void(int)> runBatch = [&](int batch) {
+        int first = static_cast<int>(static_cast<long long>(count) * batch / batches);
+        int last = static_cast<int>(static_cast<long long>(count) * (batch + 1) / batches);
+        vector<double> &best = batchBest[batch];
+        vector<int> &bestId = batchBestId[batch];
+        RuleTrajectory trajectory;
+        vector<unsigned char> signals(numDays);
+        for (int id = first; id < last; id++) {
+            if (fastWindows[id] > 0) {
+                averages.crossoverSignals(fastWindows[id], slowWindows[id], 0, numDays, signals.data());
+                trajectory.buildCrossover(signals.data(), prices, 0, numDays);
+            } else if (described[id]) {
+                trajectory.build(rules[id], prices, 0, 0, numDays);
+            }
+            for (int step = 0; step < steps; step++) {
+                int split = splitDays[step];
+                double profit = described[id] || fastWindows[id] > 0
+                    ? trajectory.windowProfit(split - options.inSampleDays, split)
+                    : fallbacks[id]->backtest(indicators, split - options.inSampleDays, split).profit;
+                if (profit > best[step]) {
+                    best[step] = profit;
+                    bestId[step] = id;
+                }
+            }
+        }
+    };
+    if (batches > 1) {
+        if (!pool) {
+            pool.reset(new WorkStealingPool(threadCount));
+        }
+        pool->parallelFor(batches, runBatch);
+    } else {
+        runBatch(0);
+    }
+
+    // Only each step's winner is backtested out of sample
+    result.steps.resize(steps);
+    for (int step = 0; step < steps; step++) {
+        WalkForwardStep &entry = result.steps[step];
+        entry.splitDay = splitDays[step];
+        entry.inSampleReturn = -numeric_limits<double>::max();
+        for (int batch = 0; batch < batches; batch++) {
+            if (batchBestId[batch][step] >= 0 && batchBest[batch][step] > entry.inSampleReturn) {
+                entry.inSampleReturn = batchBest[batch][step];
+                entry.bestId = batchBestId[batch][step];
+            }
+        }
+        if (entry.bestId < 0) {
+            // Every in-sample profit was NaN, so there is no winner to take out of sample
+            continue;
+        }
+        int id = static_cast<int>(entry.bestId);
+        int outEnd = entry.splitDay + options.outOfSampleDays;
+        if (fastWindows[id] > 0) {
+            vector<unsigned char> signals(outEnd - entry.splitDay);
+            averages.crossoverSignals(fastWindows[id], slowWindows[id], entry.splitDay, outEnd, signals.data());
+            entry.outOfSampleReturn = CrossoverSignalKernel(signals.data(), entry.splitDay).backtest(prices, entry.splitDay, outEnd).profit;
+        } else {
+            entry.outOfSampleReturn = described[id]
+                ? backtestRule(rules[id], prices, 0, entry.splitDay, outEnd).profit
+                : fallbacks[id]->backtest(indicators, entry.splitDay, outEnd).profit;
+        }
+        entry.bestName = parameters.getName(entry.bestId);
+    }
+    result.evaluated = static_cast<long long>(count) * steps;
+    return result;
+}
+
+MonteCarloResult TradingBot::runMonteCarlo(const MarketEnsemble &ensemble, const PipelineOptions &options)
+{
+    vector<const Strategy *> strategies;
+    for (int i = 0; i < strategyCount; i++) {
+        if (availableStrategies[i] != nullptr) {
+            strategies.push_back(availableStrategies[i]);
+        }
+    }
+    int endDay = ensemble.getNumTradingDays();
+    int startDay = max(endDay-(EVALUATION_WINDOW+1), 0);
+    MonteCarloPipeline pipeline(ensemble, strategies, startDay, endDay, options);
+    return pipeline.run();
+}
+
+PortfolioResult TradingBot::runPortfolio(const MultiAssetMarket &book)
+{
+    PortfolioResult result;
+    int assets = book.getNumAssets();
+    int endDay = book.getNumTradingDays();
+    if (strategyCount == 0 || assets == 0 || endDay <= 1 || book.getAllPrices().empty()) {
+        return result;
+    }
+    int startDay = max(endDay-(EVALUATION_WINDOW+1), 0);
+    result.assets = assets;
+    result.strategies = strategyCount;
+    result.profits.assign(static_cast<size_t>(assets) * strategyCount, 0.0);
+
+    // One asset per work item, evaluated like runSimulation evaluates the bot's market
+    function<void(int)> evaluateAsset = [&](int asset) {
+        Market assetMarket(0, 0, 0, 0, -1);
+        assetMarket.assignPrices(book.getAsset(asset));
+        IndicatorEngine indicators(&assetMarket, startDay, endDay);
+        for (int i = 0; i < strategyCount; i++) {
+            if (availableStrategies[i] != nullptr) {
+                availableStrategies[i]->registerIndicators(indicators);
+            }
+        }
+        indicators.freeze();
+        vector<StrategyStats> stats(strategyCount);
+        evaluatePerStrategy(indicators, startDay, endDay, stats, false);
+        double *row = result.profits.data() + static_cast<size_t>(asset) * strategyCount;
+        for (int i = 0; i < strategyCount; i++) {
+            row[i] = stats[i].profit;
+        }
+    };
+    if (threadCount > 1 && assets > 1) {
+        if (!pool) {
+            pool.reset(new WorkStealingPool(threadCount));
+        }
+        pool->parallelFor(assets, evaluateAsset);
+    } else {
+        for (int asset = 0; asset < assets; asset++) {
+            evaluateAsset(asset);
+        }
+    }
+
+    result.strategyProfit.assign(strategyCount, 0.0);
+    result.assetProfit.assign(assets, 0.0);
+    result.bestStrategy.assign(assets, -1);
+    for (int asset = 0; asset < assets; asset++) {
+        double bestProfit = -numeric_limits<double>::max();
+        for (int i = 0; i < strategyCount; i++) {
+            if (availableStrategies[i] == nullptr) {
+                continue;
+            }
+            double profit = result.getProfit(asset, i);
+            result.strategyProfit[i] += profit;
+            result.assetProfit[asset] += profit;
+            if (profit > bestProfit) {
+                result.bestStrategy[asset] = i;
+                bestProfit = profit;
+            }
+        }
+        result.totalProfit += result.assetProfit[asset];
+    }
+    double bestTotal = -numeric_limits<double>::max();
+    for (int i = 0; i < strategyCount; i++) {
+        if (availableStrategies[i] != nullptr && result.strategyProfit[i] > bestTotal) {
+            result.bestOverall = i;
+            bestTotal = result.strategyProfit[i];
+        }
+    }
+    return result;
 }
@@ -2,11 +2,20 @@
 #define TRADING_BOT_H
 
 #include <vector>
+#include <memory>
 #include "Strategy.h"
 #include "Market.h"
 #include "TrendFollowingStrategy.h"
 #include "WeightedTrendFollowingStrategy.h"
 #include "MeanReversionStrategy.h"
+#include "WorkStealingPool.h"
+#include "Leaderboard.h"
+#include "FusedBacktest.h"
+#include "ParameterGrid.h"
+#include "StrategyArena.h"
+#include "MonteCarloPipeline.h"
+#include "SimpleAverageTable.h"
+#include "MultiAssetMarket.h"
 
 struct SimulationResult
 {
@@ -17,6 +26,92 @@ struct SimulationResult
                          totalReturn(-std::numeric_limits<double>::max()) {}
 };
 
+// Outcome of TradingBot::runSweep; only the winner is ever given a name
+struct SweepResult
+{
+    long long bestId; // sweep-wide combination id, -1 if nothing was evaluated
+    string bestName;
+    double totalReturn;
+    long long evaluated;
+
+    SweepResult() : bestId(-1), totalReturn(-std::numeric_limits<double>::max()), evaluated(0) {}
+};
+
+// Settings for TradingBot::optimize. The first rung evaluates every coarseStride-th value
+// of each parameter range on the last minDays days of the evaluation window. Each later
+// rung keeps the best keepFraction of the candidates (at least minSurvivors), adds their
+// neighbours at half the previous stride and re-evaluates on twice the days, ending with
+// stride 1 on the full window.
+struct HalvingOptions
+{
+    int coarseStride;
+    double keepFraction;
+    int minSurvivors;
+    int minDays;
+
+    HalvingOptions() : coarseStride(4), keepFraction(0.25), minSurvivors(4), minDays(20) {}
+};
+
+// Settings for TradingBot::runWalkForward. Every stepDays days the window moves on: the
+// best strategy over the inSampleDays before the split day is picked and then backtested
+// on the outOfSampleDays from the split day on.
+struct WalkForwardOptions
+{
+    int inSampleDays;
+    int outOfSampleDays;
+    int stepDays;
+
+    WalkForwardOptions() : inSampleDays(EVALUATION_WINDOW), outOfSampleDays(20), stepDays(1) {}
+};
+
+// One walk-forward step: in-sample days [splitDay - inSampleDays, splitDay), out of
+// sample days [splitDay, splitDay + outOfSampleDays)
+struct WalkForwardStep
+{
+    int splitDay;
+    long long bestId; // sweep-wide id of the in-sample winner, -1 if every in-sample profit was NaN
+    string bestName;
+    double inSampleReturn;
+    double outOfSampleReturn;
+
+    WalkForwardStep() : splitDay(0), bestId(-1), inSampleReturn(0.0), outOfSampleReturn(0.0) {}
+};
+
+struct WalkForwardResult
+{
+    vector<WalkForwardStep> steps;
+    long long evaluated; // in-sample windows scored, combinations times steps
+
+    WalkForwardResult() : evaluated(0) {}
+};
+
+// Outcome of TradingBot::runPortfolio: every strategy backtested on every asset of the
+// book, strategies indexed like getStrategy
+struct PortfolioResult
+{
+    int assets;
+    int strategies;
+    vector<double> profits;        // [asset][strategy]
+    vector<double> strategyProfit; // per strategy, summed over the assets
+    vector<double> assetProfit;    // per asset, summed over the strategies
+    vector<int> bestStrategy;      // per asset, highest profit (ties to the lower index), -1 if none
+    double totalProfit;            // the whole book: every strategy trading every asset
+    int bestOverall;               // highest strategyProfit (ties to the lower index), -1 if none
+
+    PortfolioResult() : assets(0), strategies(0), totalProfit(0.0), bestOverall(-1) {}
+
+    double getProfit(int asset, int strategy) const { return profits[static_cast<size_t>(asset) * strategies + strategy]; }
+};
+
+// How runSimulation walks the price series; both give identical results
+enum EvaluationMode
+{
+    // One pass over the days per strategy, deciding through decideAction
+    PER_STRATEGY,
+    // One pass over the days for all strategies at once (see FusedBacktest)
+    FUSED
+};
+
 class TradingBot
 {
 private:
@@ -24,14 +119,95 @@ private:
     Strategy **availableStrategies;
     int strategyCount;
     int strategyCapacity;
+    vector<char> arenaOwned; // per strategy: lives in arena rather than on its own
+    StrategyArena arena;
+    int threadCount;
+    EvaluationMode evaluationMode;
+    unique_ptr<WorkStealingPool> pool;
+
+    void appendStrategy(Strategy *strategy, bool inArena);
+    bool evaluationRange(int &startDay, int &endDay) const;
+    SimulationResult simulate(Leaderboard *leaderboard);
+    SweepResult sweep(const ParameterSweep &parameters, Leaderboard *leaderboard, int chunkSize);
+    void evaluateCandidates(const ParameterSweep &parameters, IndicatorEngine &indicators, const SimpleAverageTable &averages, const vector<long long> &ids, int startDay, int endDay, vector<StrategyStats> &stats);
+    void evaluatePerStrategy(IndicatorEngine &indicators, int startDay, int endDay, vector<StrategyStats> &results, bool threaded = true);
+    void evaluateFused(IndicatorEngine &indicators, int startDay, int endDay, vector<StrategyStats> &results);
 
 public:
     TradingBot(Market *market, int initialCapacity = 10);
     ~TradingBot();
 
     void addStrategy(Strategy *strategy);
+    // Constructs a T in the bot's arena and adds it. Strategies of one type are stored
+    // together in blocks and all freed at once with the bot, which beats addStrategy(new T)
+    // when adding many thousands.
+    template <class T, class... Args>
+    T *createStrategy(Args &&...args)
+    {
+        T *strategy = arena.create<T>(std::forward<Args>(args)...);
+        appendStrategy(strategy, true);
+        return strategy;
+    }
+
+    // Adds every combination of the sweep, in sweep order, through the arena
+    void addStrategies(const ParameterSweep &parameters);
+
+    int getStrategyCount() const;
+    Strategy *getStrategy(int index) const;
+
+    // Number of threads runSimulation spreads strategies over: 1 (the default) runs
+    // serially, 0 uses every hardware thread. Results do not depend on this setting.
+    void setThreadCount(int threads);
+    int getThreadCount() const;
+
+    // PER_STRATEGY (the default) or FUSED; with several threads the fused pass is split
+    // into one batch of strategies per thread
+    void setEvaluationMode(EvaluationMode mode);
+    EvaluationMode getEvaluationMode() const;
+
     SimulationResult runSimulation();
 
+    // Same simulation, additionally recording every strategy's stats in the leaderboard
+    // (row id = index passed to getStrategy). A bounded leaderboard keeps only the top K.
+    SimulationResult runSimulation(Leaderboard &leaderboard);
+
+    static const int DEFAULT_SWEEP_CHUNK = 4096;
+
+    // Backtests every combination of the sweep over the same days as runSimulation, without
+    // creating Strategy objects: combinations are described and evaluated chunkSize at a
+    // time, and only the winner's name is built. Strategies added with addStrategy are not
+    // involved. Equivalent to adding every generated strategy, in order, and running
+    // runSimulation. Leaderboard row ids are sweep-wide ids (see ParameterSweep::getName).
+    SweepResult runSweep(const ParameterSweep &parameters, int chunkSize = DEFAULT_SWEEP_CHUNK);
+    SweepResult runSweep(const ParameterSweep &parameters, Leaderboard &leaderboard, int chunkSize = DEFAULT_SWEEP_CHUNK);
+
+    // Successive-halving search over the same sweep: a coarse grid on a short horizon,
+    // then ever finer neighbourhoods of the survivors on ever longer horizons (see
+    // HalvingOptions). Usually finds the exhaustive winner, or one close to it, for a
+    // fraction of the backtests; evaluated counts the backtests run. The reported return
+    // is always measured on the full window, like runSweep.
+    SweepResult optimize(const ParameterSweep &parameters, const HalvingOptions &options = HalvingOptions());
+
+    // Walks the windows of WalkForwardOptions across the whole price series. Indicator
+    // tables are built once for the whole series and every combination is backtested once
+    // over it; each in-sample window is then read off that run (see RuleTrajectory) rather
+    // than replayed, so a step costs O(log trades) per combination instead of O(window).
+    // In-sample returns match a fresh backtest of the window to within rounding.
+    WalkForwardResult runWalkForward(const ParameterSweep &parameters, const WalkForwardOptions &options = WalkForwardOptions());
+
+    // Backtests every strategy on every path of the ensemble, over the same trailing days
+    // runSimulation uses, with path generation and evaluation pipelined across threads
+    // (see MonteCarloPipeline). The ensemble need not be simulated: paths are generated
+    // chunk by chunk and at most result.bufferedPathCapacity of them are held at once.
+    MonteCarloResult runMonteCarlo(const MarketEnsemble &ensemble, const PipelineOptions &options = PipelineOptions());
+
+    // Backtests every strategy on every asset of a simulated book, over the same trailing
+    // days runSimulation uses, and aggregates the profits per strategy, per asset and for
+    // the whole book. Assets are spread over the bot's threads, each with its own indicator
+    // tables; sums are taken in asset and strategy order, so results do not depend on the
+    // thread count.
+    PortfolioResult runPortfolio(const MultiAssetMarket &book);
+
     // Prevent copying
     TradingBot(const TradingBot &) = delete;
     TradingBot &operator=(const TradingBot &) = delete;
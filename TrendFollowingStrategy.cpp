@@ -1,32 +1,73 @@
 #include "TrendFollowingStrategy.h"
+#include "Instrumentation.h"
+#include "LiveIndicators.h"
+#include "StrategyKernels.h"
 #include "Utils.h"
 #include <iostream>
 
 TrendFollowingStrategy::TrendFollowingStrategy()
 :Strategy(), shortMovingAverageWindow(0),longMovingAverageWindow(0){
+    setShortcutOwner(typeid(TrendFollowingStrategy));
 }
 
 TrendFollowingStrategy::TrendFollowingStrategy(const std::string &name, int shortWindow, int longWindow)
 :Strategy(name), shortMovingAverageWindow(shortWindow), longMovingAverageWindow(longWindow){
+    setShortcutOwner(typeid(TrendFollowingStrategy));
+}
+
+int TrendFollowingStrategy::getShortWindow() const
+{
+    return shortMovingAverageWindow;
+}
+
+int TrendFollowingStrategy::getLongWindow() const
+{
+    return longMovingAverageWindow;
 }
 
 Action TrendFollowingStrategy::decideAction(Market *market, int index, double currentHolding) const
 {
+    INSTRUMENT_SCOPE("TrendFollowingStrategy::decideAction");
 
     double shortAvg = calculateMovingAverage(market, index, shortMovingAverageWindow);
     double longAvg = calculateMovingAverage(market, index, longMovingAverageWindow);
-    
-    bool isUptrend = shortAvg > longAvg;
-    
-    if (isUptrend && currentHolding == 0.0) {
-        return BUY;
-    } 
-    else if (!isUptrend && currentHolding == 1.0) {
-        return SELL;
-    } 
-    else {
-        return HOLD;
-    }
+
+    return TrendFollowingKernel::decideTrend(shortAvg > longAvg, currentHolding);
+}
+
+void TrendFollowingStrategy::registerIndicators(IndicatorEngine &indicators) const
+{
+    indicators.requireSimpleAverage(shortMovingAverageWindow);
+    indicators.requireSimpleAverage(longMovingAverageWindow);
+}
+
+Action TrendFollowingStrategy::decideFromIndicators(IndicatorEngine &indicators, int index, double currentHolding) const
+{
+    double shortAvg = calculateMovingAverage(indicators, index, shortMovingAverageWindow);
+    double longAvg = calculateMovingAverage(indicators, index, longMovingAverageWindow);
+
+    return TrendFollowingKernel::decideTrend(shortAvg > longAvg, currentHolding);
+}
+
+bool TrendFollowingStrategy::buildRule(IndicatorEngine &indicators, SignalRule &rule) const
+{
+    return makeRule(indicators, shortMovingAverageWindow, longMovingAverageWindow, rule);
+}
+
+bool TrendFollowingStrategy::buildLiveRule(LiveIndicators &indicators, SignalRule &rule) const
+{
+    rule.kind = SignalRule::CROSSOVER;
+    rule.fast = indicators.simpleAverage(shortMovingAverageWindow);
+    rule.slow = indicators.simpleAverage(longMovingAverageWindow);
+    return rule.fast != nullptr && rule.slow != nullptr;
+}
+
+bool TrendFollowingStrategy::makeRule(IndicatorEngine &indicators, int shortWindow, int longWindow, SignalRule &rule)
+{
+    rule.kind = SignalRule::CROSSOVER;
+    rule.fast = indicators.simpleAverageSeries(shortWindow);
+    rule.slow = indicators.simpleAverageSeries(longWindow);
+    return rule.fast != nullptr && rule.slow != nullptr;
 }
 
 TrendFollowingStrategy **TrendFollowingStrategy::generateStrategySet(const string &baseName, int minShortWindow, int maxShortWindow, int stepShortWindow, int minLongWindow, int maxLongWindow, int stepLongWindow)
@@ -10,10 +10,21 @@ private:
     int shortMovingAverageWindow;
     int longMovingAverageWindow;
 
+protected:
+    Action decideFromIndicators(IndicatorEngine &indicators, int index, double currentHolding) const override;
+    bool buildRule(IndicatorEngine &indicators, SignalRule &rule) const override;
+    bool buildLiveRule(LiveIndicators &indicators, SignalRule &rule) const override;
+
 public:
     TrendFollowingStrategy();
     TrendFollowingStrategy(const string &name, int shortWindow, int longWindow);
+    int getShortWindow() const;
+    int getLongWindow() const;
+    using Strategy::decideAction;
     Action decideAction(Market *market, int index, double currentHolding) const override;
+    void registerIndicators(IndicatorEngine &indicators) const override;
+    // Rule for the given windows without needing a strategy object (used by parameter sweeps)
+    static bool makeRule(IndicatorEngine &indicators, int shortWindow, int longWindow, SignalRule &rule);
     static TrendFollowingStrategy **generateStrategySet(const string &name, int minShortWindow, int maxShortWindow, int stepShortWindow, int minLongWindow, int maxLongWindow, int stepLongWindow);
 };
 
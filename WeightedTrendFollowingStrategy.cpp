@@ -1,30 +1,22 @@
 #include "WeightedTrendFollowingStrategy.h"
+#include "Instrumentation.h"
+#include "LiveIndicators.h"
 #include "Utils.h"
 #include <cmath>
 
 WeightedTrendFollowingStrategy::WeightedTrendFollowingStrategy()
 :TrendFollowingStrategy(){
+    setShortcutOwner(typeid(WeightedTrendFollowingStrategy));
 }
 
 WeightedTrendFollowingStrategy::WeightedTrendFollowingStrategy(const string &name, int shortWindow, int longWindow)
 : TrendFollowingStrategy(name,shortWindow,longWindow){
-}
-
-double WeightedTrendFollowingStrategy::calculateExponentialWeight(int index) const
-{
-
-    double weight = 1.0;
-    double growthFactor = 1.1;
-    
-    for (int i = 0; i < index; i++) {
-        weight *= growthFactor;
-    }
-    
-    return weight;
+    setShortcutOwner(typeid(WeightedTrendFollowingStrategy));
 }
 
 double WeightedTrendFollowingStrategy::calculateMovingAverage(Market *market, int index, int window) const
 {
+    INSTRUMENT_SCOPE("WeightedTrendFollowingStrategy::calculateMovingAverage");
     if (index < 0 || window <= 0) {
         return market->getPrice(max(0, index));
     }
@@ -33,14 +25,13 @@ double WeightedTrendFollowingStrategy::calculateMovingAverage(Market *market, in
     double totalWeight = 0.0;
     double weightedSum = 0.0;
 
+    // Weight grows by the same factor each day, so carry it forward instead of
+    // recomputing growthFactor^position from scratch (which made this O(window^2))
+    double weight = 1.0;
     for (int i = startIdx; i <= index; i++) {
-        int position = i - startIdx; 
-        
-        
-        double weight = calculateExponentialWeight(position);
-        
         weightedSum += market->getPrice(i) * weight;
         totalWeight += weight;
+        weight *= IndicatorEngine::WEIGHT_GROWTH_FACTOR;
     }
 
     if (totalWeight <= 0.0) {
@@ -50,6 +41,38 @@ double WeightedTrendFollowingStrategy::calculateMovingAverage(Market *market, in
     return weightedSum / totalWeight;
 }
 
+void WeightedTrendFollowingStrategy::registerIndicators(IndicatorEngine &indicators) const
+{
+    indicators.requireWeightedAverage(getShortWindow());
+    indicators.requireWeightedAverage(getLongWindow());
+}
+
+double WeightedTrendFollowingStrategy::calculateMovingAverage(IndicatorEngine &indicators, int index, int window) const
+{
+    return indicators.weightedMovingAverage(index, window);
+}
+
+bool WeightedTrendFollowingStrategy::buildRule(IndicatorEngine &indicators, SignalRule &rule) const
+{
+    return makeRule(indicators, getShortWindow(), getLongWindow(), rule);
+}
+
+bool WeightedTrendFollowingStrategy::buildLiveRule(LiveIndicators &indicators, SignalRule &rule) const
+{
+    rule.kind = SignalRule::CROSSOVER;
+    rule.fast = indicators.weightedAverage(getShortWindow());
+    rule.slow = indicators.weightedAverage(getLongWindow());
+    return rule.fast != nullptr && rule.slow != nullptr;
+}
+
+bool WeightedTrendFollowingStrategy::makeRule(IndicatorEngine &indicators, int shortWindow, int longWindow, SignalRule &rule)
+{
+    rule.kind = SignalRule::CROSSOVER;
+    rule.fast = indicators.weightedAverageSeries(shortWindow);
+    rule.slow = indicators.weightedAverageSeries(longWindow);
+    return rule.fast != nullptr && rule.slow != nullptr;
+}
+
 WeightedTrendFollowingStrategy **WeightedTrendFollowingStrategy::generateStrategySet(const string &baseName, int minShortWindow, int maxShortWindow, int stepShortWindow, int minLongWindow, int maxLongWindow, int stepLongWindow)
 {
     int numShortWindows = ((maxShortWindow - minShortWindow) / stepShortWindow) + 1;
@@ -5,13 +5,17 @@
 
 class WeightedTrendFollowingStrategy : public TrendFollowingStrategy
 {
-private:
-    double calculateExponentialWeight(int index) const;
+protected:
+    bool buildRule(IndicatorEngine &indicators, SignalRule &rule) const override;
+    bool buildLiveRule(LiveIndicators &indicators, SignalRule &rule) const override;
 
 public:
     WeightedTrendFollowingStrategy();
     WeightedTrendFollowingStrategy(const string &name, int shortWindow, int longWindow);
     double calculateMovingAverage(Market *market, int index, int window) const override;
+    void registerIndicators(IndicatorEngine &indicators) const override;
+    double calculateMovingAverage(IndicatorEngine &indicators, int index, int window) const override;
+    static bool makeRule(IndicatorEngine &indicators, int shortWindow, int longWindow, SignalRule &rule);
     static WeightedTrendFollowingStrategy **generateStrategySet(const string &name, int minShortWindow, int maxShortWindow, int stepShortWindow, int minLongWindow, int maxLongWindow, int stepLongWindow);
 };
 
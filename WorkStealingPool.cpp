@@ -0,0 +1,156 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int numThreads)
+: numWorkers(numThreads > 0 ? numThreads : defaultThreadCount()), task(nullptr), generation(0), busyWorkers(0), stopping(false){
+    for (int i = 0; i < numWorkers; i++) {
+        queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    // Worker 0 is whichever thread calls parallelFor
+    for (int i = 1; i < numWorkers; i++) {
+        threads.push_back(thread(&WorkStealingPool::workerLoop, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        lock_guard<mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+int WorkStealingPool::getThreadCount() const
+{
+    return numWorkers;
+}
+
+int WorkStealingPool::defaultThreadCount()
+{
+    unsigned int hardwareThreads = thread::hardware_concurrency();
+    return hardwareThreads > 0 ? static_cast<int>(hardwareThreads) : 1;
+}
+
+void WorkStealingPool::workerLoop(int worker)
+{
+    long long seenGeneration = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(stateLock);
+            wake.wait(guard, [&]() { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        drain(worker);
+
+        lock_guard<mutex> guard(stateLock);
+        if (--busyWorkers == 0) {
+            finished.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::takeRange(int worker, Range &range)
+{
+    // Own work first, newest end: it was queued next to what this worker just finished
+    {
+        WorkerQueue &own = *queues[worker];
+        lock_guard<mutex> guard(own.lock);
+        if (!own.ranges.empty()) {
+            range = own.ranges.back();
+            own.ranges.pop_back();
+            return true;
+        }
+    }
+
+    // Then steal the oldest range from the next worker that still has some
+    for (int offset = 1; offset < numWorkers; offset++) {
+        WorkerQueue &victim = *queues[(worker + offset) % numWorkers];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.ranges.empty()) {
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::drain(int worker)
+{
+    // Every range is queued before the workers start, so once all queues are empty
+    // nothing new can appear and this worker is done for this round
+    Range range;
+    while (takeRange(worker, range)) {
+        for (int i = range.begin; i < range.end; i++) {
+            try {
+                (*task)(i);
+            } catch (...) {
+                lock_guard<mutex> guard(errorLock);
+                if (!firstError) {
+                    firstError = current_exception();
+                }
+            }
+        }
+    }
+}
+
+void WorkStealingPool::parallelFor(int count, const function<void(int)> &body)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    if (numWorkers == 1) {
+        for (int i = 0; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    // Several ranges per worker leave something to steal when costs are uneven
+    int chunk = max(1, count / (numWorkers * 8));
+    int numRanges = (count + chunk - 1) / chunk;
+    for (int r = 0; r < numRanges; r++) {
+        Range range;
+        range.begin = r * chunk;
+        range.end = min(count, range.begin + chunk);
+        // Contiguous slices per worker keep neighbouring indices on the same core
+        WorkerQueue &queue = *queues[static_cast<long long>(r) * numWorkers / numRanges];
+        lock_guard<mutex> guard(queue.lock);
+        queue.ranges.push_back(range);
+    }
+
+    firstError = nullptr;
+    {
+        lock_guard<mutex> guard(stateLock);
+        task = &body;
+        busyWorkers = numWorkers;
+        generation++;
+    }
+    wake.notify_all();
+
+    drain(0);
+
+    {
+        unique_lock<mutex> guard(stateLock);
+        if (--busyWorkers == 0) {
+            finished.notify_all();
+        }
+        finished.wait(guard, [&]() { return busyWorkers == 0; });
+        task = nullptr;
+    }
+
+    if (firstError) {
+        exception_ptr error = firstError;
+        firstError = nullptr;
+        rethrow_exception(error);
+    }
+}
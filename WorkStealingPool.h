@@ -0,0 +1,71 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Fixed set of worker threads that run index-parallel loops. Each worker owns a deque of
+// index ranges: it takes work from the back of its own deque and, when that runs dry,
+// steals from the front of another worker's deque, so uneven task costs still keep every
+// core busy. The calling thread takes part as worker 0.
+class WorkStealingPool
+{
+private:
+    struct Range
+    {
+        int begin;
+        int end;
+    };
+
+    struct WorkerQueue
+    {
+        mutex lock;
+        deque<Range> ranges;
+    };
+
+    int numWorkers;
+    vector<thread> threads;
+    vector<unique_ptr<WorkerQueue>> queues;
+
+    mutex stateLock;
+    condition_variable wake;
+    condition_variable finished;
+    const function<void(int)> *task;
+    long long generation;
+    int busyWorkers;
+    bool stopping;
+
+    mutex errorLock;
+    exception_ptr firstError;
+
+    void workerLoop(int worker);
+    void drain(int worker);
+    bool takeRange(int worker, Range &range);
+
+public:
+    // numThreads <= 0 selects defaultThreadCount()
+    explicit WorkStealingPool(int numThreads);
+    ~WorkStealingPool();
+
+    int getThreadCount() const;
+
+    // Calls task(i) for every i in [0, count) and returns once all calls have finished.
+    // The first exception thrown by a task is rethrown here.
+    void parallelFor(int count, const function<void(int)> &task);
+
+    static int defaultThreadCount();
+
+    // Prevent copying
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""Compare two bench_suite result files (JSON or CSV) and report regressions.
+
+Usage: bench_compare.py BASE NEW [--threshold PERCENT]
+
+Prints the time per iteration of every benchmark present in both files and the change
+from BASE to NEW. Exits with status 1 if any benchmark got slower by more than the
+threshold (10% by default), so it can gate a build.
+"""
+
+import argparse
+import csv
+import json
+import sys
+
+
+def load(path):
+    """Returns {name: nanoseconds per iteration} from a JSON or CSV result file."""
+    with open(path) as handle:
+        if path.endswith(".csv"):
+            return {row["name"]: float(row["real_time_ns"]) for row in csv.DictReader(handle)}
+        data = json.load(handle)
+    return {entry["name"]: float(entry["real_time"]) for entry in data["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two bench_suite runs.")
+    parser.add_argument("base")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="slowdown in percent that counts as a regression (default 10)")
+    args = parser.parse_args()
+
+    base = load(args.base)
+    new = load(args.new)
+    regressions = []
+    width = max([len(name) for name in base] + [9])
+    print("%-*s %14s %14s %9s" % (width, "Benchmark", "Base (ns)", "New (ns)", "Change"))
+    for name in base:
+        if name not in new:
+            continue
+        change = (new[name] - base[name]) / base[name] * 100.0 if base[name] > 0 else 0.0
+        marker = ""
+        if change > args.threshold:
+            regressions.append(name)
+            marker = "  REGRESSION"
+        print("%-*s %14.0f %14.0f %+8.1f%%%s" % (width, name, base[name], new[name], change, marker))
+
+    missing = [name for name in base if name not in new]
+    if missing:
+        print("\nOnly in %s: %s" % (args.base, ", ".join(missing)))
+    if regressions:
+        print("\n%d benchmark(s) slower by more than %.1f%%" % (len(regressions), args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
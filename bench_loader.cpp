@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Market.h"
+
+using namespace std;
+
+// Compares the streaming text loader behind Market::loadFromFile with the previous
+// ifstream-based loader, which read the file twice (once to count, once to fill).
+// Usage: bench_loader [price lines]   (default 10,000,000)
+
+static const string BENCH_FILE = "bench_loader_market.txt";
+
+// The loader as it was before MarketTextParser: count with one stream, then read with another
+static vector<double> legacyLoad(const string &filePath)
+{
+    ifstream inFile(filePath);
+    double initialPrice, volatility, expectedYearlyReturn;
+    int numTradingDays, seed;
+    inFile >> initialPrice >> volatility >> expectedYearlyReturn >> numTradingDays >> seed;
+
+    ifstream countFile(filePath);
+    int count = 0;
+    double dummy;
+    countFile >> dummy >> dummy >> dummy >> dummy >> dummy;
+    while (countFile >> dummy)
+        count++;
+    countFile.close();
+
+    vector<double> prices(count);
+    int pricesSize = 0;
+    double price;
+    while (pricesSize < count && inFile >> price)
+    {
+        prices[pricesSize++] = price;
+    }
+    return prices;
+}
+
+static void writeBenchFile(const string &filePath, int lines)
+{
+    // '\n' rather than endl; flushing every line would dominate the setup time
+    ofstream outFile(filePath);
+    outFile << "100 0.2 0.05 " << lines << " 42\n";
+    outFile.precision(17);
+    double price = 100.0;
+    unsigned int state = 42;
+    for (int i = 0; i < lines; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        price *= 1.0 + ((state >> 8) / 16777216.0 - 0.5) * 0.02;
+        outFile << price << '\n';
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int lines = argc > 1 ? atoi(argv[1]) : 10000000;
+    if (lines <= 0)
+    {
+        cerr << "Usage: " << argv[0] << " [price lines]" << endl;
+        return 1;
+    }
+
+    string filePath = "data/" + BENCH_FILE;
+    cout << "Writing " << lines << " prices to " << filePath << endl;
+    writeBenchFile(filePath, lines);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<double> legacy = legacyLoad(filePath);
+    double legacySeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    Market market(0, 0, 0, 0, -1);
+    start = chrono::steady_clock::now();
+    market.loadFromFile(BENCH_FILE);
+    double streamingSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    PriceView prices = market.getPriceView();
+    bool identical = prices.size() == static_cast<int>(legacy.size());
+    for (int i = 0; identical && i < prices.size(); i++)
+    {
+        identical = prices[i] == legacy[i];
+    }
+
+    cout << "Legacy two-pass loader: " << legacySeconds << " s" << endl;
+    cout << "Streaming loader:       " << streamingSeconds << " s" << endl;
+    cout << "Speedup:                " << legacySeconds / streamingSeconds << "x" << endl;
+    cout << "Prices identical:       " << (identical ? "yes" : "NO") << endl;
+
+    remove(filePath.c_str());
+    return identical ? 0 : 1;
+}
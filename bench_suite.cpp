@@ -0,0 +1,453 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Instrumentation.h"
+#include "Market.h"
+#include "MeanReversionStrategy.h"
+#include "ParameterGrid.h"
+#include "TradingBot.h"
+#include "TrendFollowingStrategy.h"
+#include "WeightedTrendFollowingStrategy.h"
+
+using namespace std;
+
+// Parameterized micro and macro benchmarks in the style of Google Benchmark: every case runs
+// its timed loop for more and more iterations until it lasts at least --min-time seconds,
+// then reports the time per iteration and the items processed per second. Results go to the
+// console and, on request, to JSON or CSV files that bench_compare.py can diff between runs.
+// In a build with make INSTRUMENT=1 it also prints the instrumentation summary of the whole
+// run, and --trace=file writes the timed scopes as Chrome trace-event JSON.
+// Usage: bench_suite [--filter=text] [--min-time=seconds] [--max-days=n] [--json=file] [--csv=file] [--trace=file]
+
+// Timing state handed to each benchmark: setup before the loop is not timed
+class BenchState
+{
+private:
+    long long iterations;
+    long long done;
+    long long itemsPerIteration;
+    chrono::steady_clock::time_point start;
+    double seconds;
+
+public:
+    vector<long long> args;
+
+    BenchState(const vector<long long> &args, long long iterations)
+    : iterations(iterations), done(0), itemsPerIteration(0), seconds(0.0), args(args) {}
+
+    bool keepRunning()
+    {
+        if (done == 0) {
+            start = chrono::steady_clock::now();
+        }
+        if (done == iterations) {
+            seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            return false;
+        }
+        done++;
+        return true;
+    }
+
+    void setItemsPerIteration(long long items) { itemsPerIteration = items; }
+    long long getIterations() const { return iterations; }
+    long long getItemsPerIteration() const { return itemsPerIteration; }
+    double getSeconds() const { return seconds; }
+};
+
+// Keeps the compiler from discarding a result that is otherwise unused
+template <class T>
+static void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Benchmark
+{
+    string name;
+    function<void(BenchState &)> body;
+    vector<vector<long long>> argSets;
+};
+
+struct BenchResult
+{
+    string name;
+    long long iterations;
+    double nanosecondsPerIteration;
+    double itemsPerSecond;
+};
+
+static long long maxDays = 10000000;
+
+static vector<long long> dayCounts(long long first, long long last)
+{
+    vector<long long> days;
+    for (long long n = first; n <= min(last, maxDays); n *= 10) {
+        days.push_back(n);
+    }
+    return days;
+}
+
+// Loader messages would swamp the table
+class SilenceCout
+{
+private:
+    streambuf *saved;
+
+public:
+    SilenceCout() : saved(cout.rdbuf(nullptr)) {}
+    ~SilenceCout() { cout.rdbuf(saved); }
+};
+
+static void benchMarketSimulate(BenchState &state)
+{
+    int days = static_cast<int>(state.args[0]);
+    Market market(100.0, 0.2, 0.05, days, 42);
+    while (state.keepRunning()) {
+        market.simulate();
+        doNotOptimize(market.getLastPrice());
+    }
+    state.setItemsPerIteration(days);
+}
+
+static void benchLoadText(BenchState &state)
+{
+    int days = static_cast<int>(state.args[0]);
+    string file = "bench_suite_" + to_string(days) + ".txt";
+    {
+        SilenceCout quiet;
+        Market source(100.0, 0.2, 0.05, days, 42);
+        source.simulate();
+        source.writeToFile(file);
+        Market market(0, 0, 0, 0, -1);
+        while (state.keepRunning()) {
+            market.loadFromFile(file);
+            doNotOptimize(market.getLastPrice());
+        }
+    }
+    remove(("data/" + file).c_str());
+    state.setItemsPerIteration(days);
+}
+
+static void benchLoadBinary(BenchState &state)
+{
+    int days = static_cast<int>(state.args[0]);
+    string file = "bench_suite_" + to_string(days) + ".bin";
+    {
+        SilenceCout quiet;
+        Market source(100.0, 0.2, 0.05, days, 42);
+        source.simulate();
+        source.writeBinary(file);
+        Market market(0, 0, 0, 0, -1);
+        while (state.keepRunning()) {
+            market.loadBinary(file);
+            doNotOptimize(market.getLastPrice());
+        }
+    }
+    remove(("data/" + file).c_str());
+    state.setItemsPerIteration(days);
+}
+
+// args: strategy kind (0 trend following, 1 weighted, 2 mean reversion), window
+static Strategy *benchStrategy(long long kind, int window)
+{
+    if (kind == 1) {
+        return new WeightedTrendFollowingStrategy("WeightedTrend", window, window * 3);
+    }
+    if (kind == 2) {
+        return new MeanReversionStrategy("MeanReversion", window, 3);
+    }
+    return new TrendFollowingStrategy("Trend", window, window * 3);
+}
+
+static const char *KIND_NAMES[] = {"TrendFollowing", "WeightedTrendFollowing", "MeanReversion"};
+
+static void benchMovingAverage(BenchState &state)
+{
+    int window = static_cast<int>(state.args[1]);
+    const int days = 10000;
+    Market market(100.0, 0.2, 0.05, days, 42);
+    market.simulate();
+    unique_ptr<Strategy> strategy(benchStrategy(state.args[0], window));
+    while (state.keepRunning()) {
+        double sum = 0.0;
+        for (int day = 0; day < days; day++) {
+            sum += strategy->calculateMovingAverage(&market, day, window);
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsPerIteration(days);
+}
+
+static void benchDecideAction(BenchState &state)
+{
+    int days = static_cast<int>(state.args[1]);
+    Market market(100.0, 0.2, 0.05, days, 42);
+    market.simulate();
+    unique_ptr<Strategy> strategy(benchStrategy(state.args[0], 10));
+    while (state.keepRunning()) {
+        double holding = 0.0;
+        for (int day = 0; day < days; day++) {
+            Action action = strategy->decideAction(&market, day, holding);
+            holding = action == BUY ? 1.0 : action == SELL ? 0.0 : holding;
+        }
+        doNotOptimize(holding);
+    }
+    state.setItemsPerIteration(days);
+}
+
+// args: strategy count. runSimulation only evaluates the last EVALUATION_WINDOW + 1 days,
+// so a longer series adds no work and the case has no day axis.
+static void benchRunSimulation(BenchState &state)
+{
+    int strategies = static_cast<int>(state.args[0]);
+    Market market(100.0, 0.2, 0.05, 1000, 42);
+    market.simulate();
+    // A third of each family, windows cycling so tables are shared as in real sweeps
+    TradingBot bot(&market);
+    for (int i = 0; i < strategies; i++) {
+        int window = 2 + i / 3 % 60;
+        bot.createStrategy<TrendFollowingStrategy>("Trend", window, window + 5 + i / 180 % 40);
+        if (++i < strategies) {
+            bot.createStrategy<WeightedTrendFollowingStrategy>("WeightedTrend", window, window + 5 + i / 180 % 40);
+        }
+        if (++i < strategies) {
+            bot.createStrategy<MeanReversionStrategy>("MeanReversion", window, 1 + i / 180 % 10);
+        }
+    }
+    while (state.keepRunning()) {
+        SimulationResult result = bot.runSimulation();
+        doNotOptimize(result.totalReturn);
+    }
+    state.setItemsPerIteration(strategies);
+}
+
+// args: days. Walk-forward steps one day at a time across the whole series, so unlike
+// runSimulation its work grows with the days; 100 combinations per step.
+static void benchWalkForward(BenchState &state)
+{
+    int days = static_cast<int>(state.args[0]);
+    Market market(100.0, 0.2, 0.05, days, 42);
+    market.simulate();
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "Trend", ParameterRange(2, 18, 4), ParameterRange(25, 70, 5)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MeanReversion", ParameterRange(5, 50, 5), ParameterRange(1, 9, 2)));
+    TradingBot bot(&market);
+    while (state.keepRunning()) {
+        WalkForwardResult result = bot.runWalkForward(sweep);
+        doNotOptimize(result.evaluated);
+    }
+    state.setItemsPerIteration(days);
+}
+
+static vector<Benchmark> registry()
+{
+    vector<Benchmark> benchmarks;
+    vector<vector<long long>> simulateArgs, loadArgs, averageArgs, decideArgs, simulationArgs, walkForwardArgs;
+    for (long long days : dayCounts(1000, 10000000)) {
+        simulateArgs.push_back({days});
+        loadArgs.push_back({days});
+    }
+    for (long long kind = 0; kind < 3; kind++) {
+        for (long long window : {5, 50, 500}) {
+            averageArgs.push_back({kind, window});
+        }
+        for (long long days : dayCounts(1000, 10000000)) {
+            decideArgs.push_back({kind, days});
+        }
+    }
+    for (long long strategies : {10, 100, 1000, 10000}) {
+        simulationArgs.push_back({strategies});
+    }
+    for (long long days : dayCounts(1000, 100000)) {
+        walkForwardArgs.push_back({days});
+    }
+    benchmarks.push_back({"BM_MarketSimulate", benchMarketSimulate, simulateArgs});
+    benchmarks.push_back({"BM_LoadText", benchLoadText, loadArgs});
+    benchmarks.push_back({"BM_LoadBinary", benchLoadBinary, loadArgs});
+    benchmarks.push_back({"BM_MovingAverage", benchMovingAverage, averageArgs});
+    benchmarks.push_back({"BM_DecideAction", benchDecideAction, decideArgs});
+    benchmarks.push_back({"BM_RunSimulation", benchRunSimulation, simulationArgs});
+    benchmarks.push_back({"BM_WalkForward", benchWalkForward, walkForwardArgs});
+    return benchmarks;
+}
+
+static string caseName(const Benchmark &benchmark, const vector<long long> &args)
+{
+    string name = benchmark.name;
+    for (size_t k = 0; k < args.size(); k++) {
+        bool kindArg = k == 0 && (benchmark.name == "BM_MovingAverage" || benchmark.name == "BM_DecideAction");
+        name += "/" + (kindArg ? string(KIND_NAMES[args[k]]) : to_string(args[k]));
+    }
+    return name;
+}
+
+// Grows the iteration count, as Google Benchmark does, until one run lasts minTime
+static BenchResult runCase(const Benchmark &benchmark, const vector<long long> &args, double minTime)
+{
+    long long iterations = 1;
+    for (;;) {
+        BenchState state(args, iterations);
+        benchmark.body(state);
+        double seconds = state.getSeconds();
+        if (seconds >= minTime || iterations >= 1000000000LL) {
+            BenchResult result;
+            result.name = caseName(benchmark, args);
+            result.iterations = iterations;
+            result.nanosecondsPerIteration = seconds * 1e9 / iterations;
+            result.itemsPerSecond = seconds > 0.0 ? state.getItemsPerIteration() * iterations / seconds : 0.0;
+            return result;
+        }
+        double scale = seconds > 0.0 ? minTime * 1.4 / seconds : 100.0;
+        iterations = max(iterations + 1, static_cast<long long>(iterations * min(scale, 100.0)));
+    }
+}
+
+static string buildDescription()
+{
+    string flags;
+#if defined(TRADING_INSTRUMENT)
+    flags += "instrumented ";
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+    flags += "sanitizers ";
+#endif
+#if defined(__OPTIMIZE__)
+    flags += "optimized";
+#else
+    flags += "unoptimized";
+#endif
+    return flags;
+}
+
+static string escapeJson(const string &text)
+{
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+static void writeJson(const string &path, const vector<BenchResult> &results)
+{
+    ofstream out(path);
+    if (!out) {
+        cerr << "Error opening file for writing: " << path << endl;
+        return;
+    }
+    time_t now = time(nullptr);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n";
+    out << "    \"compiler\": \"" << escapeJson(__VERSION__) << "\",\n";
+    out << "    \"build\": \"" << buildDescription() << "\"\n  },\n";
+    out << "  \"benchmarks\": [\n";
+    out << setprecision(10);
+    for (size_t k = 0; k < results.size(); k++) {
+        const BenchResult &result = results[k];
+        out << "    {\"name\": \"" << escapeJson(result.name) << "\", \"iterations\": " << result.iterations
+            << ", \"real_time\": " << result.nanosecondsPerIteration << ", \"time_unit\": \"ns\", \"items_per_second\": "
+            << result.itemsPerSecond << "}" << (k + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static void writeCsv(const string &path, const vector<BenchResult> &results)
+{
+    ofstream out(path);
+    if (!out) {
+        cerr << "Error opening file for writing: " << path << endl;
+        return;
+    }
+    out << "name,iterations,real_time_ns,items_per_second\n" << setprecision(10);
+    for (const BenchResult &result : results) {
+        out << result.name << ',' << result.iterations << ',' << result.nanosecondsPerIteration << ',' << result.itemsPerSecond << '\n';
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    string filter, jsonPath, csvPath, tracePath;
+    double minTime = 0.2;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t equals = arg.find('=');
+        string key = arg.substr(0, equals);
+        string value = equals == string::npos ? string() : arg.substr(equals + 1);
+        if (key == "--filter") {
+            filter = value;
+        } else if (key == "--min-time") {
+            minTime = atof(value.c_str());
+        } else if (key == "--max-days") {
+            maxDays = atoll(value.c_str());
+        } else if (key == "--json") {
+            jsonPath = value;
+        } else if (key == "--csv") {
+            csvPath = value;
+        } else if (key == "--trace") {
+            tracePath = value;
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            cerr << "Usage: bench_suite [--filter=text] [--min-time=seconds] [--max-days=n] [--json=file] [--csv=file] [--trace=file]" << endl;
+            return 1;
+        }
+    }
+
+    string build = buildDescription();
+    if (build.find("sanitizers") != string::npos) {
+        cerr << "Warning: built with sanitizers; timings are not representative" << endl;
+    }
+
+    if (!tracePath.empty()) {
+        Instrumentation::setTracing(true);
+    }
+
+    vector<BenchResult> results;
+    cout << left << setw(56) << "Benchmark" << right << setw(16) << "Time (ns)" << setw(14) << "Iterations" << setw(16) << "Items/s" << endl;
+    cout << string(102, '-') << endl;
+    for (const Benchmark &benchmark : registry()) {
+        for (const vector<long long> &args : benchmark.argSets) {
+            if (!filter.empty() && caseName(benchmark, args).find(filter) == string::npos) {
+                continue;
+            }
+            BenchResult result = runCase(benchmark, args, minTime);
+            results.push_back(result);
+            ostringstream rate;
+            rate << setprecision(4) << result.itemsPerSecond;
+            cout << left << setw(56) << result.name << right << fixed << setprecision(0) << setw(16) << result.nanosecondsPerIteration
+                 << setw(14) << result.iterations << setw(16) << rate.str() << endl;
+            cout.unsetf(ios::floatfield);
+        }
+    }
+
+    if (Instrumentation::isCompiledIn()) {
+        cout << endl;
+        Instrumentation::printSummary(cout);
+    }
+    if (!tracePath.empty()) {
+        Instrumentation::writeTrace(tracePath);
+    }
+    if (!jsonPath.empty()) {
+        writeJson(jsonPath, results);
+    }
+    if (!csvPath.empty()) {
+        writeCsv(csvPath, results);
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <iostream>
+#include <string>
+
+#include "Market.h"
+
+using namespace std;
+
+// Converts text market files in data/ to the binary format read by Market::loadBinary.
+// Usage: convert_market bullish_low_vol.txt [more.txt ...]
+// Each input is written next to it with its extension replaced by ".bin".
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: " << argv[0] << " <file in data/> [...]" << endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        string textFile = argv[i];
+        string binaryFile = textFile;
+        size_t dot = binaryFile.find_last_of('.');
+        if (dot != string::npos)
+        {
+            binaryFile.erase(dot);
+        }
+        binaryFile += ".bin";
+
+        Market market(0, 0, 0, 0, -1);
+        market.loadFromFile(textFile);
+        if (market.getPriceView().empty())
+        {
+            cerr << "Skipping " << textFile << ": no prices loaded" << endl;
+            failures++;
+            continue;
+        }
+        market.writeBinary(binaryFile);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "LiveSession.h"
+#include "MarketTextParser.h"
+#include "TradingBot.h"
+
+using namespace std;
+
+// Runs a set of strategies on prices arriving one per line, from a file or a pipe standing
+// in for a live feed, and prints each strategy's trades, P&L and tick-to-decision latency
+// at the end of the feed. Lines that are not a single number (such as the header of a
+// data/*.txt market file) are skipped.
+// Usage: live_feed [-v] [prices file]   (reads standard input without a file; -v prints every trade)
+
+static ParameterSweep liveSweep()
+{
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::WEIGHTED_TREND_FOLLOWING, "WeightedTrend", ParameterRange(5, 15, 5), ParameterRange(20, 50, 10)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "Trend", ParameterRange(5, 15, 5), ParameterRange(20, 100, 10)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MeanReversion", ParameterRange(5, 15, 5), ParameterRange(1, 5, 1)));
+    return sweep;
+}
+
+static bool parsePriceLine(const string &line, double &price)
+{
+    size_t first = 0;
+    size_t last = line.size();
+    while (first < last && isspace(static_cast<unsigned char>(line[first]))) {
+        first++;
+    }
+    while (last > first && isspace(static_cast<unsigned char>(line[last - 1]))) {
+        last--;
+    }
+    return first < last && MarketTextParser::parseDouble(line.data() + first, line.data() + last, price);
+}
+
+int main(int argc, char *argv[])
+{
+    bool verbose = false;
+    string path;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-v") {
+            verbose = true;
+        } else {
+            path = arg;
+        }
+    }
+
+    ifstream file;
+    if (!path.empty() && path != "-") {
+        file.open(path);
+        if (!file) {
+            cerr << "Error opening file for reading: " << path << endl;
+            return 1;
+        }
+    }
+    istream &feed = file.is_open() ? static_cast<istream &>(file) : cin;
+
+    Market market(0, 0, 0, 0, -1);
+    TradingBot bot(&market);
+    bot.addStrategies(liveSweep());
+    LiveSession session(bot);
+
+    string line;
+    while (getline(feed, line)) {
+        double price;
+        if (!parsePriceLine(line, price)) {
+            continue;
+        }
+        const vector<Action> &actions = session.onTick(price);
+        if (verbose) {
+            for (int slot = 0; slot < session.getStrategyCount(); slot++) {
+                if (actions[slot] != HOLD) {
+                    cout << "Day " << session.getTickCount() - 1 << ": " << session.getStrategy(slot)->getName()
+                         << (actions[slot] == BUY ? " BUY at " : " SELL at ") << price << endl;
+                }
+            }
+        }
+    }
+
+    cout << session.getTickCount() << " ticks, " << session.getStrategyCount() << " strategies" << endl << endl;
+    cout << "| Strategy | Trades | Profit | p50 (ns) | p99 (ns) |" << endl;
+    cout << "|---|---|---|---|---|" << endl;
+    cout << fixed << setprecision(3);
+    for (int slot = 0; slot < session.getStrategyCount(); slot++) {
+        StrategyStats stats = session.getStats(slot);
+        const LatencyHistogram &latency = session.getLatency(slot);
+        cout << "| " << session.getStrategy(slot)->getName() << " | " << stats.tradeCount << " | " << stats.profit
+             << " | " << latency.percentile(0.5) << " | " << latency.percentile(0.99) << " |" << endl;
+    }
+    return 0;
+}
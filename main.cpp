@@ -12,6 +12,7 @@
 #include "MeanReversionStrategy.h"
 #include "TrendFollowingStrategy.h"
 #include "WeightedTrendFollowingStrategy.h"
+#include "ParameterGrid.h"
 #include "Utils.h"
 
 using namespace std;
@@ -31,6 +32,16 @@ bool compareDouble(double a, double b)
     return fabs(a - b) < epsilon;
 }
 
+// Parameter grids of test cases 4 and 5, in the order their strategies are compared
+ParameterSweep defaultParameterSweep()
+{
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::WEIGHTED_TREND_FOLLOWING, "WeightedTrend", ParameterRange(5, 15, 5), ParameterRange(20, 50, 10)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "Trend", ParameterRange(5, 15, 5), ParameterRange(20, 100, 10)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MeanReversion", ParameterRange(5, 15, 5), ParameterRange(1, 5, 1)));
+    return sweep;
+}
+
 int main()
 {
 
@@ -151,32 +162,13 @@ int main()
         market->loadFromFile("bullish_low_vol.txt");
         TradingBot *tradingBot = new TradingBot(market);
 
-        // Generate and add strategies using separate functions
-        WeightedTrendFollowingStrategy **weightedStrategies = WeightedTrendFollowingStrategy::generateStrategySet("WeightedTrend", 5, 15, 5, 20, 50, 10);
-        for (int i = 0; i < 12; ++i)
-        {
-            tradingBot->addStrategy(weightedStrategies[i]);
-        }
-        delete[] weightedStrategies;
-
-        TrendFollowingStrategy **trendStrategies = TrendFollowingStrategy::generateStrategySet("Trend", 5, 15, 5, 20, 100, 10);
-        for (int i = 0; i < 27; ++i)
-        {
-            tradingBot->addStrategy(trendStrategies[i]);
-        }
-        delete[] trendStrategies;
-
-        MeanReversionStrategy **meanReversionStrategies = MeanReversionStrategy::generateStrategySet("MeanReversion", 5, 15, 5, 1, 5, 1);
-        for (int i = 0; i < 15; ++i)
-        {
-            tradingBot->addStrategy(meanReversionStrategies[i]);
-        }
-        delete[] meanReversionStrategies;
+        // Sweep the strategy parameter grids; strategies are described lazily, not allocated
+        ParameterSweep sweep = defaultParameterSweep();
 
         // Run simulation
-        SimulationResult result = tradingBot->runSimulation();
+        SweepResult result = tradingBot->runSweep(sweep);
 
-        cout << "Best strategy: " << result.bestStrategy->getName() << endl;
+        cout << "Best strategy: " << result.bestName << endl;
         cout << "Best return: " << result.totalReturn << endl;
 
         delete market;
@@ -192,32 +184,13 @@ int main()
         market->loadFromFile("bearish_low_vol.txt");
         TradingBot *tradingBot = new TradingBot(market);
 
-        // Generate and add strategies using separate functions
-        WeightedTrendFollowingStrategy **weightedStrategies = WeightedTrendFollowingStrategy::generateStrategySet("WeightedTrend", 5, 15, 5, 20, 50, 10);
-        for (int i = 0; i < 12; ++i)
-        {
-            tradingBot->addStrategy(weightedStrategies[i]);
-        }
-        delete[] weightedStrategies;
-
-        TrendFollowingStrategy **trendStrategies = TrendFollowingStrategy::generateStrategySet("Trend", 5, 15, 5, 20, 100, 10);
-        for (int i = 0; i < 27; ++i)
-        {
-            tradingBot->addStrategy(trendStrategies[i]);
-        }
-        delete[] trendStrategies;
-
-        MeanReversionStrategy **meanReversionStrategies = MeanReversionStrategy::generateStrategySet("MeanReversion", 5, 15, 5, 1, 5, 1);
-        for (int i = 0; i < 15; ++i)
-        {
-            tradingBot->addStrategy(meanReversionStrategies[i]);
-        }
-        delete[] meanReversionStrategies;
+        // Sweep the strategy parameter grids; strategies are described lazily, not allocated
+        ParameterSweep sweep = defaultParameterSweep();
 
         // Run simulation
-        SimulationResult result = tradingBot->runSimulation();
+        SweepResult result = tradingBot->runSweep(sweep);
 
-        cout << "Best strategy: " << result.bestStrategy->getName() << endl;
+        cout << "Best strategy: " << result.bestName << endl;
         cout << "Best return: " << result.totalReturn << endl;
 
         delete market;
@@ -0,0 +1,93 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Market.h"
+#include "TradingBot.h"
+
+using namespace std;
+
+// Compares TradingBot::optimize (successive halving) with the exhaustive runSweep on the
+// bundled markets in data/, printing a Markdown table: wall time, backtests run, the best
+// return each search found and where the optimizer's pick ranks in the exhaustive results.
+// Usage: optimize_report [file in data/ ...]   (defaults to the four bundled markets)
+
+static ParameterSweep reportSweep()
+{
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "Trend", ParameterRange(1, 150, 1), ParameterRange(1, 150, 1)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::WEIGHTED_TREND_FOLLOWING, "WeightedTrend", ParameterRange(1, 60, 1), ParameterRange(1, 120, 1)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MeanReversion", ParameterRange(1, 150, 1), ParameterRange(1, 30, 1)));
+    return sweep;
+}
+
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    vector<string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        files.push_back(argv[i]);
+    }
+    if (files.empty())
+    {
+        files = {"bullish_low_vol.txt", "bullish_high_vol.txt", "bearish_low_vol.txt", "bearish_high_vol.txt"};
+    }
+
+    ParameterSweep sweep = reportSweep();
+    HalvingOptions options;
+    cout << "Sweep of " << sweep.size() << " combinations; halving with stride " << options.coarseStride
+         << ", keep " << options.keepFraction << ", first rung " << options.minDays << " days" << endl << endl;
+    cout << "| Market | Exhaustive time (s) | Backtests | Best | Return | Halving time (s) | Backtests | Best | Return | Rank |" << endl;
+    cout << "|---|---|---|---|---|---|---|---|---|---|" << endl;
+
+    for (const string &file : files)
+    {
+        Market market(0, 0, 0, 0, -1);
+        {
+            // Keep the loader's progress messages out of the table
+            streambuf *saved = cout.rdbuf(nullptr);
+            market.loadFromFile(file);
+            cout.rdbuf(saved);
+        }
+        if (market.getPriceView().empty())
+        {
+            cerr << "Skipping " << file << ": no prices loaded" << endl;
+            continue;
+        }
+        TradingBot bot(&market);
+
+        Leaderboard exhaustiveBoard;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        SweepResult exhaustive = bot.runSweep(sweep, exhaustiveBoard);
+        double exhaustiveSeconds = secondsSince(start);
+
+        start = chrono::steady_clock::now();
+        SweepResult halving = bot.optimize(sweep, options);
+        double halvingSeconds = secondsSince(start);
+
+        // 1-based position of the optimizer's pick in the exhaustive ranking
+        exhaustiveBoard.sortByRank();
+        int rank = 0;
+        for (int row = 0; row < exhaustiveBoard.size(); row++)
+        {
+            if (exhaustiveBoard.getId(row) == halving.bestId)
+            {
+                rank = row + 1;
+                break;
+            }
+        }
+
+        cout << fixed << setprecision(4);
+        cout << "| " << file << " | " << exhaustiveSeconds << " | " << exhaustive.evaluated << " | " << exhaustive.bestName
+             << " | " << setprecision(3) << exhaustive.totalReturn << " | " << setprecision(4) << halvingSeconds << " | "
+             << halving.evaluated << " | " << halving.bestName << " | " << setprecision(3) << halving.totalReturn << " | "
+             << rank << " |" << endl;
+    }
+    return 0;
+}
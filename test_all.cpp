@@ -2,19 +2,42 @@
 #include <cassert>
 #include <cmath>
 #include <vector>
+#include <algorithm>
 #include <string>
 #include <stdexcept>
 #include <limits>
 #include <chrono>
 #include <climits>  // For INT_MAX
+#include <cstdint>  // For uintptr_t
+#include <cstdio>   // For remove
+#include <cstdlib>  // For strtod
+#include <fstream>
 
 #include "Market.h"
+#include "MarketTextParser.h"
+#include "MarketEnsemble.h"
+#include "MultiAssetMarket.h"
+#include "CounterRandom.h"
+#include "GbmKernel.h"
+#include "PriceSeries.h"
 #include "Strategy.h"
+#include "StrategyKernels.h"
 #include "TradingBot.h"
 #include "MeanReversionStrategy.h"
 #include "TrendFollowingStrategy.h"
 #include "WeightedTrendFollowingStrategy.h"
 #include "Utils.h"
+#include "ParameterGrid.h"
+#include "RuleTrajectory.h"
+#include "SimpleAverageTable.h"
+#include "MeanReversionBatch.h"
+#include "SignalHistory.h"
+#include "StrategyArena.h"
+#include "LiveSession.h"
+#include "SpscQueue.h"
+#include "Instrumentation.h"
+#include <sstream>
+#include <thread>
 
 using namespace std;
 
@@ -137,6 +160,1592 @@ void testMarket() {
     cout << "- File operations work\n";
 }
 
+// Test contiguous price storage and the zero-copy view exposed by Market
+void testPriceSeries() {
+    cout << "\n=== TESTING PRICE SERIES ===\n";
+    
+    // Storage is contiguous, aligned and zero-initialised
+    PriceSeries series(100);
+    assert(series.size() == 100);
+    assert(reinterpret_cast<uintptr_t>(series.data()) % PriceSeries::ALIGNMENT == 0);
+    for (int i = 0; i < series.size(); i++) {
+        assert(series[i] == 0.0);
+    }
+    cout << "- PriceSeries allocation is aligned and zeroed\n";
+    
+    // Copies are deep, moves transfer ownership
+    series[5] = 42.0;
+    PriceSeries copy(series);
+    copy[5] = 7.0;
+    assert(series[5] == 42.0);
+    PriceSeries moved(std::move(copy));
+    assert(moved[5] == 7.0 && copy.empty());
+    cout << "- PriceSeries copy and move semantics work\n";
+    
+    // Subviews are clamped to the underlying range
+    PriceView view = series.view();
+    PriceView tail = view.subview(95, 10);
+    assert(tail.size() == 5 && tail.data() == series.data() + 95);
+    cout << "- PriceView subview clamps correctly\n";
+    
+    // Market exposes its storage without copying
+    Market market(100.0, 0.2, 0.5, 50, 42);
+    market.simulate();
+    PriceView prices = market.getPriceView();
+    assert(prices.size() == 50);
+    assert(prices.data() == market.getPriceView().data());
+    for (int i = 0; i < prices.size(); i++) {
+        assert(prices[i] == market.getPrice(i));
+    }
+    cout << "- Market::getPriceView is zero-copy\n";
+    
+    // Legacy pointer table points straight into the contiguous storage
+    double **legacy = market.getPrices();
+    for (int i = 0; i < prices.size(); i++) {
+        assert(legacy[i] == prices.data() + i);
+    }
+    cout << "- Market::getPrices compatibility shim works\n";
+    
+    // Moving average over the view matches a manual sum, including past-the-end days
+    MeanReversionStrategy strategy("MR_View", 10, 5);
+    double sum = 0.0;
+    for (int i = 40; i < 50; i++) {
+        sum += prices[i];
+    }
+    assert(strategy.calculateMovingAverage(&market, 49, 10) == sum / 10);
+    assert(areEqual(strategy.calculateMovingAverage(&market, 52, 5), (prices[48] + prices[49]) / 5));
+    cout << "- calculateMovingAverage over PriceView works\n";
+}
+
+// Test the binary market format and zero-copy loading
+void testBinaryMarket() {
+    cout << "\n=== TESTING BINARY MARKET FORMAT ===\n";
+    
+    Market textMarket(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+    textMarket.loadFromFile("bullish_low_vol.txt");
+    textMarket.writeBinary("binary_roundtrip_test.bin");
+    
+    // Round trip keeps every parameter and price bit for bit
+    Market binaryMarket(0, 0, 0, 0, -1);
+    binaryMarket.loadBinary("binary_roundtrip_test.bin");
+    assert(binaryMarket.isMapped());
+    assert(binaryMarket.getNumTradingDays() == textMarket.getNumTradingDays());
+    assert(binaryMarket.getVolatility() == textMarket.getVolatility());
+    assert(binaryMarket.getExpectedYearlyReturn() == textMarket.getExpectedYearlyReturn());
+    assert(reinterpret_cast<uintptr_t>(binaryMarket.getPriceView().data()) % sizeof(double) == 0);
+    for (int i = 0; i < textMarket.getNumTradingDays(); i++) {
+        assert(binaryMarket.getPrice(i) == textMarket.getPrice(i));
+    }
+    cout << "- writeBinary/loadBinary round trip is exact\n";
+    
+    // A mapped market backtests exactly like the text one
+    TradingBot textBot(&textMarket);
+    TradingBot binaryBot(&binaryMarket);
+    textBot.addStrategy(new TrendFollowingStrategy("TF", 10, 15));
+    binaryBot.addStrategy(new TrendFollowingStrategy("TF", 10, 15));
+    assert(textBot.runSimulation().totalReturn == binaryBot.runSimulation().totalReturn);
+    cout << "- Mapped market gives identical simulation results\n";
+    
+    // Saving a mapped market over its own file keeps every price
+    binaryMarket.writeBinary("binary_roundtrip_test.bin");
+    assert(binaryMarket.isMapped());
+    for (int i = 0; i < textMarket.getNumTradingDays(); i++) {
+        assert(binaryMarket.getPrice(i) == textMarket.getPrice(i));
+    }
+    Market resavedMarket(0, 0, 0, 0, -1);
+    resavedMarket.loadBinary("binary_roundtrip_test.bin");
+    assert(resavedMarket.getNumTradingDays() == textMarket.getNumTradingDays());
+    for (int i = 0; i < textMarket.getNumTradingDays(); i++) {
+        assert(resavedMarket.getPrice(i) == textMarket.getPrice(i));
+    }
+    cout << "- Re-saving a mapped market onto its source file is safe\n";
+    
+    // Simulating a mapped market moves it back to owned storage
+    binaryMarket.simulate();
+    assert(!binaryMarket.isMapped());
+    assert(binaryMarket.getPriceView().size() == binaryMarket.getNumTradingDays());
+    cout << "- Simulating a mapped market switches to owned storage\n";
+    
+    // Files that are not binary markets are rejected and leave the market untouched
+    binaryMarket.loadBinary("bullish_low_vol.txt");
+    assert(!binaryMarket.isMapped());
+    assert(binaryMarket.getNumTradingDays() == TRADING_DAYS_PER_YEAR);
+    cout << "- Invalid binary files are rejected\n";
+    
+    remove("data/binary_roundtrip_test.bin");
+}
+
+// Test the streaming text loader used by Market::loadFromFile
+void testMarketTextParser() {
+    cout << "\n=== TESTING MARKET TEXT PARSER ===\n";
+    
+    // Number conversion agrees with strtod, including inputs that miss the exact fast path
+    const char *numbers[] = {"0", "-0", "100", "101.25", "3.14159265358979", "0.1", "1e-5", "2.5E+3",
+                             "99.123456789012345678", "1e300", "123456789012345678901234", "4.9e-324",
+                             "+1.00000000000000000000001", "1e400", "-1e400", "1e-400", "-2.5e-400", "123456789012345678901234e290"};
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+        string text = numbers[i];
+        double parsed = 0.0;
+        assert(MarketTextParser::parseDouble(text.data(), text.data() + text.size(), parsed));
+        assert(parsed == strtod(text.c_str(), nullptr));
+    }
+    const char *invalid[] = {"", "-", ".", "1.2.3", "12abc", "1e", "nan"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        string text = invalid[i];
+        double parsed = 0.0;
+        assert(!MarketTextParser::parseDouble(text.data(), text.data() + text.size(), parsed));
+    }
+    cout << "- parseDouble matches strtod and rejects malformed numbers\n";
+    
+    // Malformed lines are skipped and counted, blank lines and CRLF endings are tolerated
+    {
+        ofstream outFile("data/text_parser_test.txt");
+        outFile << "100 0.2 0.05 4 7\r\n101.5\r\n\nabc\n102.25\n1.2.3\n  103  \n104";
+    }
+    MarketTextHeader header;
+    PriceSeries prices;
+    MarketTextParser parser("data/text_parser_test.txt");
+    assert(parser.parse(header, prices));
+    assert(header.initialPrice == 100.0 && header.numTradingDays == 4 && header.seed == 7);
+    assert(parser.getMalformedLines() == 2);
+    assert(prices.size() == 4);
+    assert(prices[0] == 101.5 && prices[1] == 102.25 && prices[2] == 103.0 && prices[3] == 104.0);
+    
+    PriceSeries limited;
+    {
+        ofstream outFile("data/text_parser_test.txt");
+        outFile << "100 0.2 0.05 2 7\n1\n2\n3\n";
+    }
+    assert(parser.parse(header, limited, true));
+    assert(limited.size() == 2);
+    cout << "- Malformed lines are reported and skipped\n";
+    
+    // A header claiming far more days than the file can hold only sizes the first allocation
+    {
+        ofstream outFile("data/text_parser_test.txt");
+        outFile << "100 0.2 0.05 2000000000 7\n1\n2\n";
+    }
+    PriceSeries inflated;
+    assert(parser.parse(header, inflated));
+    assert(header.numTradingDays == 2000000000);
+    assert(inflated.size() == 2 && inflated[0] == 1.0 && inflated[1] == 2.0);
+    cout << "- Oversized header day counts do not drive the allocation\n";
+    
+    // A bad header is rejected without touching the output
+    {
+        ofstream outFile("data/text_parser_test.txt");
+        outFile << "100 0.2 not-a-number 2 7\n1\n";
+    }
+    assert(!parser.parse(header, limited));
+    assert(limited.size() == 2);
+    remove("data/text_parser_test.txt");
+    cout << "- Malformed headers are rejected\n";
+    
+    // Every shipped data file loads to the same prices as the old stream-based reader
+    const char *files[] = {"bullish_low_vol.txt", "bullish_high_vol.txt", "bearish_low_vol.txt", "bearish_high_vol.txt"};
+    for (size_t f = 0; f < sizeof(files) / sizeof(files[0]); f++) {
+        Market market(0, 0, 0, 0, -1);
+        market.loadFromFile(files[f]);
+        ifstream inFile(string("data/") + files[f]);
+        double value;
+        for (int i = 0; i < 5; i++) {
+            inFile >> value;
+        }
+        int count = 0;
+        while (inFile >> value) {
+            assert(count < market.getPriceView().size());
+            assert(market.getPriceView()[count] == value);
+            count++;
+        }
+        assert(count == market.getPriceView().size());
+    }
+    cout << "- Loaded prices match the stream-based reader on every data file\n";
+}
+
+// Test batch generation of GBM paths
+void testMarketEnsemble() {
+    cout << "\n=== TESTING MARKET ENSEMBLE ===\n";
+    
+    // Philox4x32-10 known-answer vector from the Random123 distribution
+    uint32_t counter[4] = {0, 0, 0, 0};
+    uint32_t block[4];
+    Philox4x32(0).generate(counter, block);
+    assert(block[0] == 0x6627e8d5 && block[1] == 0xe169c58d && block[2] == 0xbc57ac4c && block[3] == 0x9b00dbd8);
+    cout << "- Philox4x32-10 matches the reference output\n";
+    
+    // Same seed gives the same paths whatever the thread count
+    MarketEnsemble serial(100.0, 0.2, 0.05, 300, 64, 12345);
+    serial.simulate();
+    MarketEnsemble parallel(100.0, 0.2, 0.05, 300, 64, 12345);
+    parallel.setThreadCount(4);
+    parallel.simulate();
+    assert(serial.getAllPrices().size() == 64 * 300);
+    for (int i = 0; i < serial.getAllPrices().size(); i++) {
+        assert(serial.getAllPrices()[i] == parallel.getAllPrices()[i]);
+    }
+    cout << "- Paths are identical for 1 and 4 threads\n";
+    
+    // A path depends only on the seed and its index, not on how many paths are generated
+    MarketEnsemble fewer(100.0, 0.2, 0.05, 300, 5, 12345);
+    fewer.simulate();
+    for (int day = 0; day < 300; day++) {
+        assert(fewer.getPrice(4, day) == serial.getPrice(4, day));
+    }
+    MarketEnsemble otherSeed(100.0, 0.2, 0.05, 300, 5, 54321);
+    otherSeed.simulate();
+    assert(otherSeed.getPrice(4, 299) != serial.getPrice(4, 299));
+    assert(serial.getPrice(0, 299) != serial.getPrice(1, 299));
+    cout << "- Paths are independent of the ensemble size and differ across seeds and paths\n";
+    
+    // Prices follow Market::simulate's conventions: rounded to 3 decimals, starting at the initial price
+    for (int path = 0; path < serial.getNumPaths(); path++) {
+        PriceView prices = serial.getPath(path);
+        assert(prices.size() == 300 && prices[0] == 100.0);
+        for (int day = 0; day < prices.size(); day++) {
+            assert(prices[day] > 0.0);
+            assert(prices[day] == roundToDecimals(prices[day], 3));
+        }
+    }
+    assert(serial.getPath(64).empty());
+    assert(serial.getPrice(-1, 0) == 0.0);
+    cout << "- Paths start at the initial price and are rounded like Market::simulate\n";
+    
+    // The mean log return over many paths approaches the GBM drift
+    MarketEnsemble large(100.0, 0.2, 0.05, TRADING_DAYS_PER_YEAR + 1, 2000, 7);
+    large.setThreadCount(0);
+    large.simulate();
+    double meanLogReturn = 0.0;
+    for (int path = 0; path < large.getNumPaths(); path++) {
+        meanLogReturn += log(large.getPrice(path, TRADING_DAYS_PER_YEAR) / 100.0);
+    }
+    meanLogReturn /= large.getNumPaths();
+    assert(fabs(meanLogReturn - (0.05 - 0.5 * 0.2 * 0.2)) < 0.02);
+    cout << "- Mean yearly log return matches the drift\n";
+    
+    // Any path can be backtested through a regular Market
+    Market market(100.0, 0.2, 0.05, 0, -1);
+    market.assignPrices(serial.getPath(3));
+    assert(market.getNumTradingDays() == 300);
+    assert(market.getLastPrice() == serial.getPrice(3, 299));
+    TradingBot bot(&market);
+    bot.addStrategy(new TrendFollowingStrategy("TF", 5, 20));
+    bot.runSimulation();
+    cout << "- Ensemble paths can be backtested through Market::assignPrices\n";
+}
+
+// Test the vectorized GBM path kernel against the serial formula
+void testGbmKernel() {
+    cout << "\n=== TESTING GBM KERNEL ===\n";
+    
+    const int days = 1000;
+    double deltaT = 1.0 / TRADING_DAYS_PER_YEAR;
+    double drift = (0.05 - 0.5 * (0.3 * 0.3)) * deltaT;
+    double diffusion = 0.3 * sqrt(deltaT);
+    vector<double> normals(days - 1);
+    Philox4x32 random(99);
+    for (int i = 0; i + 1 < days; i += 2) {
+        uint32_t counter[4] = {static_cast<uint32_t>(i), 0, 0, 0};
+        double second;
+        random.normalPair(counter, normals[i], second);
+        if (i + 1 < days - 1) {
+            normals[i + 1] = second;
+        }
+    }
+    
+    // Exact rounding reproduces the original per-day chain bit for bit
+    vector<double> reference(days);
+    reference[0] = roundToDecimals(123.4567, 3);
+    for (int i = 1; i < days; i++) {
+        reference[i] = roundToDecimals(reference[i - 1] * exp((0.05 - 0.5 * (0.3 * 0.3)) * deltaT + (0.3 * sqrt(deltaT) * normals[i - 1])), 3);
+    }
+    vector<double> exact(days);
+    GbmKernel::simulatePath(123.4567, drift, diffusion, normals.data(), days, true, exact.data());
+    assert(exact == reference);
+    
+    // Draws may be stored in the output buffer itself
+    vector<double> inPlace(days);
+    copy(normals.begin(), normals.end(), inPlace.begin() + 1);
+    GbmKernel::simulatePath(123.4567, drift, diffusion, inPlace.data() + 1, days, true, inPlace.data());
+    assert(inPlace == reference);
+    cout << "- Exact rounding matches the per-day formula, also in place\n";
+    
+    // The log-space path stays within rounding distance of the exact chain, on every instruction set
+    GbmKernel::InstructionSet sets[] = {GbmKernel::SCALAR, GbmKernel::SSE41, GbmKernel::AVX2};
+    vector<double> scalar(days);
+    GbmKernel::simulatePath(123.4567, drift, diffusion, normals.data(), days, false, scalar.data(), GbmKernel::SCALAR);
+    for (int s = 0; s < 3; s++) {
+        for (int length = 0; length <= 9; length++) {
+            // Short lengths exercise the scalar tails after the vector loops
+            int n = length == 9 ? days : length;
+            vector<double> fast(max(n, 1), -1.0);
+            GbmKernel::simulatePath(123.4567, drift, diffusion, normals.data(), n, false, fast.data(), sets[s]);
+            for (int i = 0; i < n; i++) {
+                assert(fast[i] == roundToDecimals(fast[i], 3));
+                assert(fabs(fast[i] - scalar[i]) <= 0.001 + 1e-12 * scalar[i]);
+                assert(fabs(fast[i] - reference[i]) <= 1e-5 * reference[i] * (i + 1) + 0.001);
+            }
+        }
+    }
+    cout << "- Log-space kernel (" << GbmKernel::name(GbmKernel::bestAvailable()) << " available) tracks the exact chain\n";
+    
+    // Markets and ensembles keep exact rounding unless asked otherwise
+    Market market(100.0, 0.2, 0.05, 50, 42);
+    assert(market.getExactRounding());
+    market.setExactRounding(false);
+    market.simulate();
+    assert(market.getPrice(0) == 100.0 && market.getPrice(49) > 0.0);
+    MarketEnsemble exactEnsemble(100.0, 0.2, 0.05, 300, 8, 3);
+    MarketEnsemble fastEnsemble(100.0, 0.2, 0.05, 300, 8, 3);
+    fastEnsemble.setExactRounding(false);
+    exactEnsemble.simulate();
+    fastEnsemble.simulate();
+    for (int path = 0; path < 8; path++) {
+        for (int day = 0; day < 300; day++) {
+            double expected = exactEnsemble.getPrice(path, day);
+            assert(fabs(fastEnsemble.getPrice(path, day) - expected) <= 1e-5 * expected * (day + 1) + 0.001);
+        }
+    }
+    cout << "- Exact rounding is the default and the fast mode can be selected per market\n";
+}
+
+// Strategy without a SignalRule, forcing the fused backtest onto its decideAction fallback
+class AlternatingStrategy : public Strategy {
+public:
+    AlternatingStrategy() : Strategy("Alternating") {}
+    Action decideAction(Market *market, int index, double currentHolding) const override {
+        (void)market;
+        if (index % 3 == 0) {
+            return currentHolding == 0.0 ? BUY : HOLD;
+        }
+        return index % 3 == 2 && currentHolding == 1.0 ? SELL : HOLD;
+    }
+};
+
+// Test the single-pass multi-strategy evaluation against the per-strategy path
+void testFusedBacktest() {
+    cout << "\n=== TESTING FUSED BACKTEST ===\n";
+    
+    const char *files[] = {"bullish_low_vol.txt", "bullish_high_vol.txt", "bearish_low_vol.txt", "bearish_high_vol.txt"};
+    for (size_t f = 0; f < sizeof(files) / sizeof(files[0]); f++) {
+        Market market(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+        market.loadFromFile(files[f]);
+        
+        Leaderboard expected;
+        TradingBot reference(&market);
+        for (int threads : {1, 3}) {
+            TradingBot fused(&market);
+            fused.setEvaluationMode(FUSED);
+            fused.setThreadCount(threads);
+            for (TradingBot *bot : {&reference, &fused}) {
+                if (bot == &reference && threads != 1) {
+                    continue;
+                }
+                for (int s = 5; s <= 30; s += 5) {
+                    for (int l = 10; l <= 100; l += 15) {
+                        bot->addStrategy(new TrendFollowingStrategy("TF", s, l));
+                        bot->addStrategy(new WeightedTrendFollowingStrategy("WTF", s, l));
+                    }
+                    for (int t = 1; t <= 10; t += 3) {
+                        bot->addStrategy(new MeanReversionStrategy("MR", s, t));
+                    }
+                }
+                bot->addStrategy(new AlternatingStrategy());
+                bot->addStrategy(new TrendFollowingStrategy("TF_bad", 0, 10));
+            }
+            if (threads == 1) {
+                reference.runSimulation(expected);
+                expected.sortByRank();
+            }
+            Leaderboard actual;
+            SimulationResult result = fused.runSimulation(actual);
+            actual.sortByRank();
+            
+            assert(actual.size() == expected.size());
+            for (int row = 0; row < actual.size(); row++) {
+                assert(actual.getId(row) == expected.getId(row));
+                assert(actual.getProfit(row) == expected.getProfit(row));
+                assert(actual.getTradeCount(row) == expected.getTradeCount(row));
+                assert(actual.getWinRate(row) == expected.getWinRate(row));
+                assert(actual.getMaxDrawdown(row) == expected.getMaxDrawdown(row));
+                assert(actual.getExposureDays(row) == expected.getExposureDays(row));
+            }
+            assert(result.bestStrategy == fused.getStrategy(static_cast<int>(actual.getId(0))));
+        }
+    }
+    cout << "- Fused evaluation reproduces every per-strategy stat, serially and in batches\n";
+    
+    // Strategies without a rule are still evaluated, through decideAction
+    Market market(100.0, 0.2, 0.05, 120, 5);
+    market.simulate();
+    IndicatorEngine indicators(&market, 19, 120);
+    TrendFollowingStrategy trend("TF", 5, 10);
+    AlternatingStrategy alternating;
+    trend.registerIndicators(indicators);
+    indicators.freeze();
+    FusedBacktest backtest(indicators, 19, 120);
+    backtest.addStrategy(&trend);
+    backtest.addStrategy(&alternating);
+    assert(backtest.getStrategyCount() == 2 && backtest.getFallbackCount() == 1);
+    vector<StrategyStats> results;
+    backtest.run(results);
+    assert(results.size() == 2 && results[1].tradeCount > 0);
+    cout << "- Strategies without a SignalRule fall back to decideAction\n";
+}
+
+// AlternatingStrategy deciding a whole range per call, counting calls of both entry points
+class BatchAlternatingStrategy : public AlternatingStrategy {
+public:
+    mutable int rangeCalls = 0;
+    mutable int dayCalls = 0;
+    Action decideAction(Market *market, int index, double currentHolding) const override {
+        dayCalls++;
+        return AlternatingStrategy::decideAction(market, index, currentHolding);
+    }
+    void decideActions(IndicatorEngine &indicators, int startDay, int endDay, Action *actions) const override {
+        (void)indicators;
+        rangeCalls++;
+        double holding = 0.0;
+        for (int day = startDay; day < endDay; day++) {
+            Action action = day % 3 == 0 ? (holding == 0.0 ? BUY : HOLD) : (day % 3 == 2 && holding == 1.0 ? SELL : HOLD);
+            actions[day - startDay] = action;
+            holding = action == BUY ? 1.0 : action == SELL ? 0.0 : holding;
+        }
+    }
+};
+
+// Test the batch decideActions entry point and its per-day fallback
+void testDecideActions() {
+    cout << "\n=== TESTING BATCH DECIDE ACTIONS ===\n";
+    
+    Market market(100.0, 0.3, 0.1, 400, 21);
+    market.simulate();
+    int startDay = 150, endDay = 400;
+    IndicatorEngine indicators(&market, startDay, endDay);
+    vector<Strategy *> strategies;
+    for (int s = 3; s <= 30; s += 9) {
+        strategies.push_back(new TrendFollowingStrategy("TF", s, s * 3));
+        strategies.push_back(new WeightedTrendFollowingStrategy("WTF", s, s * 3));
+        strategies.push_back(new MeanReversionStrategy("MR", s, s % 7));
+    }
+    strategies.push_back(new AlternatingStrategy());
+    for (Strategy *strategy : strategies) {
+        strategy->registerIndicators(indicators);
+    }
+    indicators.freeze();
+    
+    // Built-in strategies decide from their tables exactly what decideAction would every day
+    vector<Action> batch(endDay - startDay), perDay(endDay - startDay);
+    for (Strategy *strategy : strategies) {
+        for (int start : {startDay, startDay + 17}) {
+            strategy->decideActions(indicators, start, endDay, batch.data());
+            DecideActionKernel(*strategy, indicators).decideActions(market.getPriceView().data(), start, endDay, perDay.data());
+            assert(equal(batch.begin(), batch.begin() + (endDay - start), perDay.begin()));
+        }
+    }
+    TrendFollowingStrategy wide("TF", 5, 20);
+    vector<Action> wideBatch(endDay - 50), widePerDay(endDay - 50);
+    wide.decideActions(indicators, 50, endDay, wideBatch.data());
+    DecideActionKernel(wide, indicators).decideActions(market.getPriceView().data(), 50, endDay, widePerDay.data());
+    assert(wideBatch == widePerDay);
+    for (Strategy *strategy : strategies) {
+        delete strategy;
+    }
+    cout << "- Batch decisions match per-day decideAction, inside and outside the engine's range\n";
+    
+    // runSimulation makes one decideActions call per strategy, in both evaluation modes
+    BatchAlternatingStrategy reference;
+    int windowStart = endDay - (EVALUATION_WINDOW + 1);
+    StrategyStats expected = DecideActionKernel(reference, indicators).backtest(market.getPriceView().data(), windowStart, endDay);
+    assert(reference.dayCalls == endDay - windowStart);
+    for (EvaluationMode mode : {PER_STRATEGY, FUSED}) {
+        TradingBot bot(&market);
+        bot.setEvaluationMode(mode);
+        BatchAlternatingStrategy *batched = new BatchAlternatingStrategy();
+        bot.addStrategy(batched);
+        Leaderboard board;
+        bot.runSimulation(board);
+        assert(batched->rangeCalls == 1 && batched->dayCalls == 0);
+        assert(board.getProfit(0) == expected.profit && board.getTradeCount(0) == expected.tradeCount);
+    }
+    cout << "- runSimulation consumes one batch per strategy without per-day calls\n";
+}
+
+// Subclasses of the built-in strategies that only override the Market-based methods
+class HoldingTrendStrategy : public TrendFollowingStrategy {
+public:
+    HoldingTrendStrategy() : TrendFollowingStrategy("HoldingTF", 5, 20) {}
+    Action decideAction(Market *market, int index, double currentHolding) const override {
+        (void)market;
+        (void)index;
+        (void)currentHolding;
+        return HOLD;
+    }
+};
+
+class InvertedWeightedStrategy : public WeightedTrendFollowingStrategy {
+public:
+    InvertedWeightedStrategy() : WeightedTrendFollowingStrategy("InvertedWTF", 4, 15) {}
+    double calculateMovingAverage(Market *market, int index, int window) const override {
+        return -WeightedTrendFollowingStrategy::calculateMovingAverage(market, index, window);
+    }
+};
+
+class StrictMeanReversionStrategy : public MeanReversionStrategy {
+public:
+    StrictMeanReversionStrategy() : MeanReversionStrategy("StrictMR", 10, 2) {}
+    Action decideAction(Market *market, int index, double currentHolding) const override {
+        Action action = MeanReversionStrategy::decideAction(market, index, currentHolding);
+        return action == BUY && index % 2 == 1 ? HOLD : action;
+    }
+};
+
+// Profit of the original runSimulation loop, calling decideAction(Market *) every day
+double marketLoopProfit(const Strategy &strategy, Market &market, int startDay) {
+    double profit = 0.0, holding = 0.0, buyPrice = 0.0;
+    int days = market.getNumTradingDays();
+    for (int day = startDay; day < days; day++) {
+        Action action = strategy.decideAction(&market, day, holding);
+        if (action == BUY && holding == 0.0) {
+            buyPrice = market.getPrice(day);
+            holding = 1.0;
+        } else if (action == SELL && holding == 1.0) {
+            profit += market.getPrice(day) - buyPrice;
+            holding = 0.0;
+        }
+    }
+    if (holding == 1.0) {
+        profit += market.getPrice(days - 1) - buyPrice;
+    }
+    return profit;
+}
+
+// Test that overrides in subclasses of the built-in strategies decide on every path
+void testStrategySubclasses() {
+    cout << "\n=== TESTING BUILT-IN STRATEGY SUBCLASSES ===\n";
+    
+    Market market(100, 0.3, 0.2, 300, 42);
+    market.simulate();
+    int startDay = market.getNumTradingDays() - (EVALUATION_WINDOW + 1);
+    HoldingTrendStrategy holding;
+    InvertedWeightedStrategy inverted;
+    StrictMeanReversionStrategy strict;
+    vector<const Strategy *> subclasses = {&holding, &inverted, &strict};
+    
+    IndicatorEngine indicators(&market, startDay, market.getNumTradingDays());
+    LiveIndicators live;
+    for (const Strategy *strategy : subclasses) {
+        strategy->registerIndicators(indicators);
+    }
+    indicators.freeze();
+    for (const Strategy *strategy : subclasses) {
+        double expected = marketLoopProfit(*strategy, market, startDay);
+        SignalRule rule;
+        assert(!strategy->usesShortcuts());
+        assert(!strategy->describeRule(indicators, rule) && !strategy->describeLiveRule(live, rule));
+        assert(strategy->backtest(indicators, startDay, market.getNumTradingDays()).profit == expected);
+        vector<Action> batch(market.getNumTradingDays() - startDay);
+        strategy->decideActions(indicators, startDay, market.getNumTradingDays(), batch.data());
+        assert(ActionBufferKernel(batch.data(), startDay).backtest(market.getPriceView().data(), startDay, market.getNumTradingDays()).profit == expected);
+    }
+    WeightedTrendFollowingStrategy weighted("WTF", 4, 15);
+    assert(weighted.usesShortcuts() && TrendFollowingStrategy().usesShortcuts() && MeanReversionStrategy().usesShortcuts());
+    assert(marketLoopProfit(inverted, market, startDay) != marketLoopProfit(weighted, market, startDay));
+    cout << "- Subclasses get no rule and backtest through their Market-based overrides\n";
+    
+    // runSimulation scores them like the original per-day loop, in both evaluation modes
+    for (EvaluationMode mode : {PER_STRATEGY, FUSED}) {
+        TradingBot bot(&market);
+        bot.setEvaluationMode(mode);
+        bot.addStrategy(new HoldingTrendStrategy());
+        bot.addStrategy(new InvertedWeightedStrategy());
+        bot.addStrategy(new StrictMeanReversionStrategy());
+        Leaderboard board;
+        bot.runSimulation(board);
+        assert(board.size() == 3);
+        for (int row = 0; row < board.size(); row++) {
+            int id = static_cast<int>(board.getId(row));
+            assert(board.getProfit(row) == marketLoopProfit(*subclasses[id], market, startDay));
+        }
+    }
+    TradingBot holdingBot(&market);
+    holdingBot.addStrategy(new HoldingTrendStrategy());
+    assert(holdingBot.runSimulation().totalReturn == 0.0);
+    cout << "- runSimulation honours the overrides in both evaluation modes\n";
+}
+
+// Test the compile-time strategy kernels behind Strategy::backtest
+void testStrategyKernels() {
+    cout << "\n=== TESTING STRATEGY KERNELS ===\n";
+    
+    const char *files[] = {"bullish_low_vol.txt", "bullish_high_vol.txt", "bearish_low_vol.txt", "bearish_high_vol.txt"};
+    for (size_t f = 0; f < sizeof(files) / sizeof(files[0]); f++) {
+        Market market(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+        market.loadFromFile(files[f]);
+        int endDay = market.getNumTradingDays();
+        int startDay = endDay - 101;
+        IndicatorEngine indicators(&market, startDay, endDay);
+        
+        vector<Strategy *> strategies;
+        for (int s = 5; s <= 30; s += 5) {
+            for (int l = 10; l <= 100; l += 30) {
+                strategies.push_back(new TrendFollowingStrategy("TF", s, l));
+                strategies.push_back(new WeightedTrendFollowingStrategy("WTF", s, l));
+            }
+            for (int t = 1; t <= 10; t += 3) {
+                strategies.push_back(new MeanReversionStrategy("MR", s, t));
+            }
+        }
+        for (Strategy *strategy : strategies) {
+            strategy->registerIndicators(indicators);
+        }
+        indicators.freeze();
+        
+        // The specialized kernel agrees with deciding through the virtual call every day
+        for (Strategy *strategy : strategies) {
+            StrategyStats kernel = strategy->backtest(indicators, startDay, endDay);
+            StrategyStats virtualCalls = DecideActionKernel(*strategy, indicators).backtest(market.getPriceView().data(), startDay, endDay);
+            assert(kernel.profit == virtualCalls.profit);
+            assert(kernel.tradeCount == virtualCalls.tradeCount);
+            assert(kernel.winningTrades == virtualCalls.winningTrades);
+            assert(kernel.maxDrawdown == virtualCalls.maxDrawdown);
+            assert(kernel.exposureDays == virtualCalls.exposureDays);
+            delete strategy;
+        }
+    }
+    cout << "- Kernels match per-day decideAction on every data file\n";
+    
+    // Kernels also run without any Strategy object
+    Market market(100.0, 0.2, 0.05, 200, 11);
+    market.simulate();
+    IndicatorEngine indicators(&market, 99, 200);
+    TrendFollowingStrategy trend("TF", 5, 20);
+    trend.registerIndicators(indicators);
+    TrendFollowingKernel kernel(indicators.simpleAverageSeries(5), indicators.simpleAverageSeries(20), 99);
+    StrategyStats direct = kernel.backtest(market.getPriceView().data(), 99, 200);
+    assert(direct.profit == trend.backtest(indicators, 99, 200).profit);
+    
+    // Out-of-range requests fall back to per-day decisions instead of reading past the tables
+    StrategyStats wider = trend.backtest(indicators, 50, 200);
+    StrategyStats expected = DecideActionKernel(trend, indicators).backtest(market.getPriceView().data(), 50, 200);
+    assert(wider.profit == expected.profit && wider.tradeCount == expected.tradeCount);
+    cout << "- Kernels run standalone and fall back outside the engine's range\n";
+}
+
+// Test lazy parameter-grid sweeps against materialized strategy sets
+void testParameterSweep() {
+    cout << "\n=== TESTING PARAMETER SWEEP ===\n";
+    
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::WEIGHTED_TREND_FOLLOWING, "WeightedTrend", ParameterRange(5, 15, 5), ParameterRange(20, 50, 10)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "Empty", ParameterRange(5, 1, 1), ParameterRange(1, 5, 1)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "Trend", ParameterRange(5, 15, 5), ParameterRange(20, 100, 10)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MeanReversion", ParameterRange(5, 15, 5), ParameterRange(1, 5, 1)));
+    assert(sweep.size() == 12 + 27 + 15);
+    
+    // Ids map to the same names, in the same order, as generateStrategySet
+    WeightedTrendFollowingStrategy **weighted = WeightedTrendFollowingStrategy::generateStrategySet("WeightedTrend", 5, 15, 5, 20, 50, 10);
+    TrendFollowingStrategy **trend = TrendFollowingStrategy::generateStrategySet("Trend", 5, 15, 5, 20, 100, 10);
+    MeanReversionStrategy **meanReversion = MeanReversionStrategy::generateStrategySet("MeanReversion", 5, 15, 5, 1, 5, 1);
+    vector<Strategy *> generated;
+    generated.insert(generated.end(), weighted, weighted + 12);
+    generated.insert(generated.end(), trend, trend + 27);
+    generated.insert(generated.end(), meanReversion, meanReversion + 15);
+    delete[] weighted;
+    delete[] trend;
+    delete[] meanReversion;
+    for (long long id = 0; id < sweep.size(); id++) {
+        assert(sweep.getName(id) == generated[id]->getName());
+    }
+    assert(sweep.getName(-1).empty() && sweep.getName(sweep.size()).empty());
+    cout << "- Sweep ids reproduce generateStrategySet names and order\n";
+    
+    // Sweeping gives exactly the stats of running the materialized strategies
+    Market market(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+    market.loadFromFile("bearish_high_vol.txt");
+    TradingBot reference(&market);
+    for (Strategy *strategy : generated) {
+        reference.addStrategy(strategy);
+    }
+    Leaderboard expected;
+    SimulationResult expectedResult = reference.runSimulation(expected);
+    expected.sortByRank();
+    for (int threads : {1, 3}) {
+        for (int chunk : {1, 7, TradingBot::DEFAULT_SWEEP_CHUNK}) {
+            TradingBot bot(&market);
+            bot.setThreadCount(threads);
+            Leaderboard actual;
+            SweepResult result = bot.runSweep(sweep, actual, chunk);
+            actual.sortByRank();
+            assert(result.evaluated == sweep.size());
+            assert(result.bestName == expectedResult.bestStrategy->getName());
+            assert(result.totalReturn == expectedResult.totalReturn);
+            assert(actual.size() == expected.size());
+            for (int row = 0; row < actual.size(); row++) {
+                assert(actual.getId(row) == expected.getId(row));
+                assert(actual.getProfit(row) == expected.getProfit(row));
+                assert(actual.getMaxDrawdown(row) == expected.getMaxDrawdown(row));
+            }
+        }
+    }
+    cout << "- runSweep matches runSimulation for any chunk size and thread count\n";
+    
+    // Large grids stream through a bounded leaderboard; winners are named on demand
+    ParameterSweep large;
+    large.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "TF", ParameterRange(1, 100, 1), ParameterRange(1, 100, 1)));
+    large.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MR", ParameterRange(0, 100, 1), ParameterRange(1, 20, 1)));
+    TradingBot bot(&market);
+    Leaderboard top(10);
+    SweepResult result = bot.runSweep(large, top, 1000);
+    top.sortByRank();
+    assert(result.evaluated == 100 * 100 + 101 * 20);
+    assert(top.size() == 10 && top.getCandidatesSeen() == result.evaluated);
+    assert(top.getId(0) == result.bestId && top.getProfit(0) == result.totalReturn);
+    unique_ptr<Strategy> winner(large.createStrategy(result.bestId));
+    assert(winner->getName() == result.bestName);
+    cout << "- Large sweeps stream through a bounded leaderboard\n";
+    
+    TradingBot empty(&market);
+    assert(empty.runSweep(ParameterSweep()).bestId == -1);
+}
+
+// Test the successive-halving optimizer against exhaustive sweeps
+void testOptimizer() {
+    cout << "\n=== TESTING SUCCESSIVE HALVING OPTIMIZER ===\n";
+    
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "Trend", ParameterRange(1, 40, 1), ParameterRange(1, 60, 1)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MeanReversion", ParameterRange(1, 40, 1), ParameterRange(1, 10, 1)));
+    
+    Market market(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+    market.loadFromFile("bullish_high_vol.txt");
+    TradingBot bot(&market);
+    Leaderboard exhaustiveBoard;
+    SweepResult exhaustive = bot.runSweep(sweep, exhaustiveBoard);
+    
+    // Stride 1 is a single full-horizon rung over every combination: the exhaustive search
+    HalvingOptions single;
+    single.coarseStride = 1;
+    SweepResult full = bot.optimize(sweep, single);
+    assert(full.bestId == exhaustive.bestId && full.totalReturn == exhaustive.totalReturn);
+    assert(full.evaluated == sweep.size());
+    cout << "- Stride 1 reproduces the exhaustive sweep\n";
+    
+    // The default search runs far fewer backtests and reports a full-window return
+    SweepResult halving = bot.optimize(sweep);
+    assert(halving.bestId >= 0 && halving.evaluated < sweep.size() / 2);
+    assert(halving.bestName == sweep.getName(halving.bestId));
+    exhaustiveBoard.sortByRank();
+    bool found = false;
+    for (int row = 0; row < exhaustiveBoard.size(); row++) {
+        if (exhaustiveBoard.getId(row) == halving.bestId) {
+            assert(exhaustiveBoard.getProfit(row) == halving.totalReturn);
+            assert(row < exhaustiveBoard.size() / 20);
+            found = true;
+        }
+    }
+    assert(found);
+    cout << "- Default halving lands in the top 5% with " << halving.evaluated << " of " << sweep.size() << " backtests\n";
+    
+    // Thread count does not change the search
+    TradingBot parallel(&market);
+    parallel.setThreadCount(3);
+    SweepResult parallelResult = parallel.optimize(sweep);
+    assert(parallelResult.bestId == halving.bestId && parallelResult.evaluated == halving.evaluated);
+    cout << "- Parallel optimizer follows the same search path\n";
+}
+
+// Test walk-forward windows read off one long backtest against fresh window backtests
+void testWalkForward() {
+    cout << "\n=== TESTING WALK-FORWARD MODE ===\n";
+    
+    Market market(100.0, 0.35, 0.2, 600, 4242);
+    market.simulate();
+    int numDays = market.getNumTradingDays();
+    IndicatorEngine indicators(&market, 0, numDays);
+    const double *prices = indicators.getPrices().data();
+    
+    // Crossovers, bands and overlapping bands (lower factor above the upper one)
+    vector<SignalRule> rules(4);
+    TrendFollowingStrategy::makeRule(indicators, 3, 12, rules[0]);
+    WeightedTrendFollowingStrategy::makeRule(indicators, 5, 20, rules[1]);
+    MeanReversionStrategy::makeRule(indicators, 10, 3, rules[2]);
+    MeanReversionStrategy::makeRule(indicators, 4, -2, rules[3]);
+    RuleTrajectory trajectory;
+    int windows = 0;
+    for (size_t r = 0; r < rules.size(); r++) {
+        trajectory.build(rules[r], prices, 0, 0, numDays);
+        assert(trajectory.getTradeCount() > 0);
+        for (int start = 0; start < numDays; start += 7) {
+            for (int length : {1, 2, 15, 100, 333}) {
+                int end = min(start + length, numDays);
+                double expected = backtestRule(rules[r], prices, 0, start, end).profit;
+                assert(areEqual(trajectory.windowProfit(start, end), expected, 1e-9));
+                windows++;
+            }
+        }
+    }
+    cout << "- " << windows << " windows match fresh backtests\n";
+    
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "Trend", ParameterRange(0, 20, 4), ParameterRange(5, 45, 10)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MeanReversion", ParameterRange(5, 25, 10), ParameterRange(1, 9, 2)));
+    WalkForwardOptions options;
+    options.inSampleDays = 60;
+    options.outOfSampleDays = 10;
+    options.stepDays = 3;
+    TradingBot bot(&market);
+    WalkForwardResult result = bot.runWalkForward(sweep, options);
+    assert(!result.steps.empty() && result.evaluated == sweep.size() * static_cast<long long>(result.steps.size()));
+    assert(result.steps.front().splitDay == 60 && result.steps.back().splitDay + 10 <= numDays);
+    
+    // Every step against fresh backtests of each combination (window 0 falls back to decideAction)
+    for (const WalkForwardStep &step : result.steps) {
+        double best = -numeric_limits<double>::max();
+        for (long long id = 0; id < sweep.size(); id++) {
+            unique_ptr<Strategy> strategy(sweep.createStrategy(id));
+            best = max(best, strategy->backtest(indicators, step.splitDay - 60, step.splitDay).profit);
+        }
+        assert(areEqual(step.inSampleReturn, best, 1e-9));
+        unique_ptr<Strategy> winner(sweep.createStrategy(step.bestId));
+        assert(winner->getName() == step.bestName);
+        assert(areEqual(winner->backtest(indicators, step.splitDay - 60, step.splitDay).profit, best, 1e-9));
+        assert(winner->backtest(indicators, step.splitDay, step.splitDay + 10).profit == step.outOfSampleReturn);
+    }
+    cout << "- " << result.steps.size() << " steps pick the in-sample winner\n";
+    
+    TradingBot parallel(&market);
+    parallel.setThreadCount(3);
+    WalkForwardResult parallelResult = parallel.runWalkForward(sweep, options);
+    for (size_t k = 0; k < result.steps.size(); k++) {
+        assert(parallelResult.steps[k].bestId == result.steps[k].bestId);
+        assert(parallelResult.steps[k].outOfSampleReturn == result.steps[k].outOfSampleReturn);
+    }
+    cout << "- Parallel walk-forward picks the same winners\n";
+    
+    // A rising series that turns into NaN makes every in-sample profit NaN: no winner, no lookup
+    vector<double> broken(50);
+    for (int day = 0; day < 50; day++) {
+        broken[day] = day < 30 ? 100.0 + day : numeric_limits<double>::quiet_NaN();
+    }
+    Market brokenMarket(0, 0, 0, 50, -1);
+    brokenMarket.assignPrices(PriceView(broken.data(), 50));
+    ParameterSweep trendSweep;
+    trendSweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "Trend", ParameterRange(2, 6, 2), ParameterRange(8, 12, 4)));
+    WalkForwardOptions brokenOptions;
+    brokenOptions.inSampleDays = 40;
+    brokenOptions.outOfSampleDays = 10;
+    brokenOptions.stepDays = 20;
+    TradingBot brokenBot(&brokenMarket);
+    WalkForwardResult brokenResult = brokenBot.runWalkForward(trendSweep, brokenOptions);
+    assert(brokenResult.steps.size() == 1);
+    assert(brokenResult.steps[0].bestId == -1 && brokenResult.steps[0].bestName.empty());
+    assert(brokenResult.steps[0].outOfSampleReturn == 0.0);
+    cout << "- Steps without an in-sample winner are left empty\n";
+    
+    // Windows that do not fit the series give no steps
+    options.inSampleDays = numDays;
+    assert(bot.runWalkForward(sweep, options).steps.empty());
+}
+
+// Strategy that counts its destructions, for checking arena teardown
+// Test the prefix-sum average table and its exact crossover signals
+void testSimpleAverageTable() {
+    cout << "\n=== TESTING SIMPLE AVERAGE TABLE ===\n";
+    
+    Market market(100.0, 0.3, 0.1, 2520, 77);
+    market.simulate();
+    int numDays = market.getNumTradingDays();
+    vector<int> windows;
+    for (int window = 1; window <= 120; window += 7) {
+        windows.push_back(window);
+    }
+    windows.push_back(windows[3]); // duplicates share a row
+    windows.push_back(0);          // ignored
+    SimpleAverageTable averages(market.getPriceView(), 0, numDays, windows);
+    IndicatorEngine indicators(&market, 0, numDays);
+    assert(!averages.hasWindow(0) && !averages.hasWindow(2) && averages.averageSeries(2) == nullptr);
+    for (int window : {1, 36, 120}) {
+        assert(averages.hasWindow(window));
+        const double *series = averages.averageSeries(window);
+        for (int day = 0; day < numDays; day++) {
+            assert(areEqual(series[day], indicators.simpleMovingAverage(day, window), 1e-8));
+        }
+    }
+    cout << "- Prefix-sum averages agree with the reference to within rounding\n";
+    
+    // Signals for every pair equal comparing the reference averages, over any day range
+    vector<unsigned char> signals(numDays);
+    for (size_t a = 0; a + 2 < windows.size(); a++) {
+        for (size_t b = 0; b + 2 < windows.size(); b++) {
+            int start = static_cast<int>(a * 37 % 500);
+            int end = numDays - static_cast<int>(b * 11);
+            averages.crossoverSignals(windows[a], windows[b], start, end, signals.data());
+            for (int day = start; day < end; day++) {
+                bool expected = indicators.simpleMovingAverage(day, windows[a]) > indicators.simpleMovingAverage(day, windows[b]);
+                assert(signals[day - start] == (expected ? 1 : 0));
+            }
+        }
+    }
+    cout << "- Crossover signals match the reference comparison for every pair\n";
+    
+    // Flat prices tie every pair; 0.1 does not sum exactly, so ties must be settled the reference way
+    for (double price : {100.0, 0.1}) {
+        vector<double> flat(300, price);
+        Market flatMarket(0, 0, 0, 0, -1);
+        flatMarket.assignPrices(PriceView(flat.data(), static_cast<int>(flat.size())));
+        SimpleAverageTable flatAverages(flatMarket.getPriceView(), 0, 300, {3, 10, 50});
+        IndicatorEngine flatIndicators(&flatMarket, 0, 300);
+        assert(flatAverages.crossoverSignals(3, 50, 0, 300, signals.data()) > 0);
+        for (int day = 0; day < 300; day++) {
+            bool expected = flatIndicators.simpleMovingAverage(day, 3) > flatIndicators.simpleMovingAverage(day, 50);
+            assert(signals[day] == (expected ? 1 : 0));
+        }
+    }
+    cout << "- Near ties fall back to the reference averages\n";
+    
+    // Table-driven sweeps give the same stats as backtesting each strategy
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "TF", ParameterRange(2, 30, 4), ParameterRange(10, 90, 20)));
+    TradingBot bot(&market);
+    Leaderboard board;
+    bot.runSweep(sweep, board);
+    int startDay = numDays - (EVALUATION_WINDOW + 1);
+    IndicatorEngine window(&market, startDay, numDays);
+    for (long long id = 0; id < sweep.size(); id++) {
+        unique_ptr<Strategy> strategy(sweep.createStrategy(id));
+        StrategyStats expected = strategy->backtest(window, startDay, numDays);
+        int row = static_cast<int>(id);
+        assert(board.getId(row) == id && board.getProfit(row) == expected.profit && board.getTradeCount(row) == expected.tradeCount);
+        assert(board.getMaxDrawdown(row) == expected.maxDrawdown && board.getExposureDays(row) == expected.exposureDays);
+    }
+    cout << "- Sweeps over the table match per-strategy backtests\n";
+}
+
+class CountedStrategy : public TrendFollowingStrategy {
+public:
+    static int destroyed;
+    CountedStrategy(const string &name, int shortWindow, int longWindow) : TrendFollowingStrategy(name, shortWindow, longWindow) {}
+    ~CountedStrategy() override { destroyed++; }
+};
+int CountedStrategy::destroyed = 0;
+
+// Test pooled strategy storage and the bot's arena-backed strategies
+// Bitwise-equal stats, NaN matching NaN
+bool sameStats(const StrategyStats &a, const StrategyStats &b) {
+    bool sameProfit = a.profit == b.profit || (std::isnan(a.profit) && std::isnan(b.profit));
+    bool sameDrawdown = a.maxDrawdown == b.maxDrawdown || (std::isnan(a.maxDrawdown) && std::isnan(b.maxDrawdown));
+    return sameProfit && sameDrawdown && a.tradeCount == b.tradeCount && a.winningTrades == b.winningTrades
+        && a.exposureDays == b.exposureDays;
+}
+
+void testMeanReversionBatch() {
+    cout << "\n=== TESTING MEAN REVERSION BATCH ===\n";
+    
+    Market market(100.0, 0.4, 0.05, 1500, 91);
+    market.simulate();
+    int numDays = market.getNumTradingDays();
+    IndicatorEngine indicators(&market, 0, numDays);
+    const double *prices = market.getPriceView().data();
+    const double *average = indicators.simpleAverageSeries(20);
+    
+    // Odd band counts leave a partial register; negative and crossed bands are legal too
+    vector<double> lowers, uppers;
+    for (int threshold = -3; threshold <= 22; threshold++) {
+        lowers.push_back(1.0 - threshold / 100.0);
+        uppers.push_back(1.0 + threshold / 100.0);
+    }
+    lowers.push_back(1.05);
+    uppers.push_back(0.95);
+    for (int bands : {1, 3, 4, 7, static_cast<int>(lowers.size())}) {
+        MeanReversionBatch batch(prices, average, 0);
+        for (int b = 0; b < bands; b++) {
+            batch.addBand(lowers[b], uppers[b]);
+        }
+        assert(batch.getBandCount() == bands);
+        for (MeanReversionBatch::InstructionSet set : {MeanReversionBatch::SCALAR, MeanReversionBatch::bestAvailable()}) {
+            for (int start : {0, 37, numDays - 1, numDays}) {
+                vector<StrategyStats> results;
+                batch.run(start, numDays, results, set);
+                assert(static_cast<int>(results.size()) == bands);
+                for (int b = 0; b < bands; b++) {
+                    StrategyStats expected = MeanReversionKernel(average, 0, lowers[b], uppers[b]).backtest(prices, start, numDays);
+                    assert(sameStats(results[b], expected));
+                }
+            }
+        }
+    }
+    cout << "- Every band matches its own backtest exactly, full and partial registers\n";
+    
+    // NaN and infinite prices take the same branches in the lanes as in the kernel
+    vector<double> odd(400);
+    for (int day = 0; day < 400; day++) {
+        odd[day] = 100.0 + 10.0 * sin(day * 0.3);
+    }
+    odd[150] = numeric_limits<double>::quiet_NaN();
+    odd[300] = numeric_limits<double>::infinity();
+    Market oddMarket(0, 0, 0, 0, -1);
+    oddMarket.assignPrices(PriceView(odd.data(), static_cast<int>(odd.size())));
+    IndicatorEngine oddIndicators(&oddMarket, 0, 400);
+    const double *oddAverage = oddIndicators.simpleAverageSeries(5);
+    MeanReversionBatch oddBatch(odd.data(), oddAverage, 0);
+    for (size_t b = 0; b < 8; b++) {
+        oddBatch.addBand(lowers[b], uppers[b]);
+    }
+    vector<StrategyStats> oddResults;
+    oddBatch.run(0, 400, oddResults);
+    for (size_t b = 0; b < 8; b++) {
+        assert(sameStats(oddResults[b], MeanReversionKernel(oddAverage, 0, lowers[b], uppers[b]).backtest(odd.data(), 0, 400)));
+    }
+    cout << "- Non-finite prices give the same stats as the kernel\n";
+    
+    // Sweeps and runSimulation batch thresholds per window, serially and threaded
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MR", ParameterRange(3, 40, 9), ParameterRange(0, 40, 1)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::TREND_FOLLOWING, "TF", ParameterRange(2, 10, 4), ParameterRange(20, 40, 10)));
+    int startDay = numDays - (EVALUATION_WINDOW + 1);
+    IndicatorEngine window(&market, startDay, numDays);
+    for (int threads : {1, 3}) {
+        TradingBot bot(&market);
+        bot.setThreadCount(threads);
+        Leaderboard board;
+        bot.runSweep(sweep, board, 50);
+        for (long long id = 0; id < sweep.size(); id++) {
+            unique_ptr<Strategy> strategy(sweep.createStrategy(id));
+            StrategyStats expected = strategy->backtest(window, startDay, numDays);
+            int row = static_cast<int>(id);
+            assert(board.getId(row) == id && board.getProfit(row) == expected.profit && board.getTradeCount(row) == expected.tradeCount);
+            assert(board.getMaxDrawdown(row) == expected.maxDrawdown && board.getExposureDays(row) == expected.exposureDays);
+        }
+        
+        TradingBot simBot(&market);
+        simBot.setThreadCount(threads);
+        for (int threshold = 0; threshold < 45; threshold++) {
+            simBot.addStrategy(new MeanReversionStrategy("MR" + to_string(threshold), 10 + threshold % 2, threshold));
+        }
+        simBot.addStrategy(new TrendFollowingStrategy("TF", 5, 20));
+        Leaderboard simBoard;
+        simBot.runSimulation(simBoard);
+        for (int threshold = 0; threshold < 45; threshold++) {
+            MeanReversionStrategy strategy("MR", 10 + threshold % 2, threshold);
+            StrategyStats expected = strategy.backtest(window, startDay, numDays);
+            assert(simBoard.getId(threshold) == threshold && simBoard.getProfit(threshold) == expected.profit);
+            assert(simBoard.getMaxDrawdown(threshold) == expected.maxDrawdown && simBoard.getExposureDays(threshold) == expected.exposureDays);
+        }
+    }
+    cout << "- Sweeps and simulations match per-strategy backtests\n";
+}
+
+void testSignalHistory() {
+    cout << "\n=== TESTING SIGNAL HISTORY ===\n";
+    
+    Market market(100.0, 0.3, 0.1, 700, 13);
+    market.simulate();
+    int numDays = market.getNumTradingDays();
+    vector<double> prices(market.getPriceView().data(), market.getPriceView().data() + numDays);
+    prices[400] = numeric_limits<double>::quiet_NaN();
+    
+    // Rows with long runs, short runs, all set, none set and day-by-day flips
+    int firstDay = 30;
+    SignalHistory history(firstDay, numDays);
+    int days = numDays - firstDay;
+    vector<vector<unsigned char>> rows;
+    Philox4x32 random(5);
+    for (int r = 0; r < 6; r++) {
+        vector<unsigned char> signals(days);
+        for (int day = 0; day < days; day++) {
+            uint32_t counter[4] = {static_cast<uint32_t>(r), static_cast<uint32_t>(day), 0, 0};
+            uint32_t out[4];
+            random.generate(counter, out);
+            uint32_t bits = out[0];
+            signals[day] = r == 0 ? 1 : r == 1 ? 0 : r == 2 ? day % 2 : r == 3 ? (day / 70) % 2 : (bits % (r * 3)) == 0;
+        }
+        int row = history.addRow();
+        history.setRow(row, signals.data());
+        rows.push_back(signals);
+    }
+    assert(history.getRowCount() == 6 && history.getMemoryBytes() == 6 * ((days + 63) / 64) * sizeof(uint64_t));
+    for (int r = 0; r < 6; r++) {
+        for (int day = firstDay; day < numDays; day++) {
+            assert(history.get(r, day) == (rows[r][day - firstDay] != 0));
+        }
+    }
+    cout << "- Rows pack one bit per day\n";
+    
+    // Every window, on and off word boundaries, against the per-day kernel
+    for (int r = 0; r < 6; r++) {
+        for (int start = firstDay; start < numDays; start += 13) {
+            for (int end : {start, start + 1, start + 63, start + 64, start + 100, numDays - 1, numDays}) {
+                if (end < start || end > numDays) {
+                    continue;
+                }
+                StrategyStats expected = CrossoverSignalKernel(rows[r].data(), firstDay).backtest(prices.data(), start, end);
+                assert(sameStats(history.backtest(r, prices.data(), start, end), expected));
+                double profit = history.windowProfit(r, prices.data(), start, end);
+                assert(profit == expected.profit || (std::isnan(profit) && std::isnan(expected.profit)));
+            }
+        }
+    }
+    StrategyStats outside = history.backtest(3, prices.data(), numDays, numDays + 10);
+    assert(outside.profit == 0.0 && outside.tradeCount == 0);
+    cout << "- Transition backtests match the per-day kernel for every window\n";
+}
+
+void testStrategyArena() {
+    cout << "\n=== TESTING STRATEGY ARENA ===\n";
+    
+    {
+        StrategyArena arena(1024);
+        vector<Strategy *> trends, reversions;
+        for (int i = 0; i < 100; i++) {
+            trends.push_back(arena.create<CountedStrategy>("TF_" + to_string(i), 5, 20 + i));
+            reversions.push_back(arena.create<MeanReversionStrategy>("MR_" + to_string(i), 10, i % 7 + 1));
+        }
+        assert(arena.getObjectCount() == 200 && arena.getPoolCount() == 2);
+        assert(arena.getBlockCount() < 200 / 2);
+        
+        // Interleaved creation still keeps each type's objects packed in creation order
+        size_t stride = reinterpret_cast<char *>(trends[1]) - reinterpret_cast<char *>(trends[0]);
+        assert(stride >= sizeof(CountedStrategy) && stride < sizeof(CountedStrategy) + alignof(max_align_t));
+        assert(trends[2] == reinterpret_cast<Strategy *>(reinterpret_cast<char *>(trends[1]) + stride));
+        assert(trends[42]->getName() == "TF_42" && reversions[99]->getName() == "MR_99");
+        
+        CountedStrategy::destroyed = 0;
+        arena.clear();
+        assert(CountedStrategy::destroyed == 100 && arena.getObjectCount() == 0 && arena.getBlockCount() == 0);
+        arena.create<CountedStrategy>("Reused", 1, 2);
+        CountedStrategy::destroyed = 0;
+    }
+    assert(CountedStrategy::destroyed == 1);
+    cout << "- Per-type pools pack objects and tear them down in bulk\n";
+    
+    // Arena strategies mixed with heap ones give the same simulation as heap-only bots
+    Market market(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+    market.loadFromFile("bearish_high_vol.txt");
+    ParameterSweep sweep;
+    sweep.addGrid(ParameterGrid(ParameterGrid::WEIGHTED_TREND_FOLLOWING, "WeightedTrend", ParameterRange(2, 20, 3), ParameterRange(10, 60, 10)));
+    sweep.addGrid(ParameterGrid(ParameterGrid::MEAN_REVERSION, "MeanReversion", ParameterRange(0, 30, 5), ParameterRange(1, 8, 1)));
+    
+    TradingBot heapBot(&market, 0);
+    TradingBot arenaBot(&market, 0);
+    for (long long id = 0; id < sweep.size(); id++) {
+        heapBot.addStrategy(sweep.createStrategy(id));
+    }
+    arenaBot.addStrategies(sweep);
+    heapBot.addStrategy(new TrendFollowingStrategy("Extra", 4, 9));
+    TrendFollowingStrategy *extra = arenaBot.createStrategy<TrendFollowingStrategy>("Extra", 4, 9);
+    assert(arenaBot.getStrategy(arenaBot.getStrategyCount() - 1) == extra);
+    
+    Leaderboard heapBoard, arenaBoard;
+    SimulationResult heapResult = heapBot.runSimulation(heapBoard);
+    SimulationResult arenaResult = arenaBot.runSimulation(arenaBoard);
+    assert(heapBot.getStrategyCount() == arenaBot.getStrategyCount());
+    assert(heapResult.bestStrategy->getName() == arenaResult.bestStrategy->getName());
+    assert(heapResult.totalReturn == arenaResult.totalReturn);
+    assert(heapBoard.getProfits() == arenaBoard.getProfits());
+    SweepResult swept = arenaBot.runSweep(sweep);
+    assert(swept.bestName == arenaBot.getStrategy(static_cast<int>(swept.bestId))->getName());
+    cout << "- Arena-backed bot matches a heap-backed one over " << arenaBot.getStrategyCount() << " strategies\n";
+    
+    // Bots own heap strategies and arena strategies side by side
+    {
+        TradingBot mixed(&market, 1);
+        CountedStrategy::destroyed = 0;
+        mixed.addStrategy(new CountedStrategy("Heap", 3, 8));
+        mixed.createStrategy<CountedStrategy>("Arena", 3, 8);
+    }
+    assert(CountedStrategy::destroyed == 2);
+    cout << "- Mixed ownership frees every strategy once\n";
+}
+
+// Test streaming ticks through ring-buffered incremental indicators against backtests
+void testLiveSession() {
+    cout << "\n=== TESTING LIVE SESSION ===\n";
+    
+    PriceRing ring(3);
+    assert(ring.getCapacity() == 4);
+    for (int day = 0; day < 10; day++) {
+        ring.append(day * 1.5);
+    }
+    assert(ring.getDayCount() == 10 && ring.getLastPrice() == 13.5);
+    assert(ring.holds(6) && !ring.holds(5) && ring[6] == 9.0);
+    ring.reserve(6);
+    assert(ring.getCapacity() == 8 && ring.holds(6) && ring[7] == 10.5 && ring[9] == 13.5);
+    cout << "- Ring buffer wraps and grows in place\n";
+    
+    LatencyHistogram histogram;
+    assert(histogram.percentile(0.5) == 0);
+    for (uint64_t ns = 1; ns <= 1000; ns++) {
+        histogram.record(ns);
+    }
+    assert(histogram.getCount() == 1000 && histogram.getMax() == 1000);
+    assert(histogram.percentile(0.5) >= 500 && histogram.percentile(0.5) <= 500 * 1.125);
+    assert(histogram.percentile(0.99) >= 990 && histogram.percentile(0.99) <= 1000);
+    assert(histogram.percentile(0.0) == 1);
+    cout << "- Latency percentiles within a bucket of the exact values\n";
+    
+    // Windows can only be added late while the ring still holds their prices
+    LiveIndicators late;
+    late.simpleAverage(3);
+    for (int day = 0; day < 100; day++) {
+        late.append(100.0 + day);
+    }
+    assert(late.simpleAverage(50) == nullptr);
+    const double *recent = late.simpleAverage(2);
+    assert(recent != nullptr && *recent == 198.5);
+    assert(late.simpleAverage(0) == nullptr && late.getAverageCount() == 2);
+    
+    const char *files[] = {"bullish_low_vol.txt", "bullish_high_vol.txt", "bearish_low_vol.txt", "bearish_high_vol.txt"};
+    for (size_t f = 0; f < sizeof(files) / sizeof(files[0]); f++) {
+        Market market(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+        market.loadFromFile(files[f]);
+        int numDays = market.getNumTradingDays();
+        TradingBot bot(&market);
+        bot.addStrategy(new TrendFollowingStrategy("TF", 5, 20));
+        bot.addStrategy(new TrendFollowingStrategy("TF_long", 12, 90));
+        bot.addStrategy(new WeightedTrendFollowingStrategy("WTF", 7, 30));
+        bot.addStrategy(new MeanReversionStrategy("MR", 10, 2));
+        bot.addStrategy(new MeanReversionStrategy("MR_wide", 20, 5));
+        LiveSession session(bot);
+        
+        // Added after 60 ticks: trades from then on, like a backtest starting that day
+        TrendFollowingStrategy lateStrategy("TF_late", 3, 10);
+        IndicatorEngine indicators(&market, 0, numDays);
+        int tradeDays = 0;
+        for (int day = 0; day < numDays; day++) {
+            if (day == 60) {
+                assert(session.addStrategy(&lateStrategy) == 5);
+            }
+            const vector<Action> &actions = session.onTick(market.getPrice(day));
+            for (Action action : actions) {
+                tradeDays += action != HOLD ? 1 : 0;
+            }
+        }
+        assert(session.getTickCount() == numDays && tradeDays > 0);
+        for (int slot = 0; slot < session.getStrategyCount(); slot++) {
+            int startDay = slot == 5 ? 60 : 0;
+            StrategyStats expected = session.getStrategy(slot)->backtest(indicators, startDay, numDays);
+            StrategyStats actual = session.getStats(slot);
+            assert(session.isLive(slot));
+            assert(actual.tradeCount == expected.tradeCount && actual.exposureDays == expected.exposureDays);
+            assert(areEqual(actual.profit, expected.profit, 1e-9));
+            assert(session.getLatency(slot).getCount() == static_cast<uint64_t>(numDays - startDay));
+        }
+    }
+    cout << "- Streamed decisions match full backtests on every bundled market\n";
+    
+    // Square and sawtooth waves tie many pairs of averages, and averages with prices, to
+    // within rounding; those comparisons must still go the backtest's way
+    vector<double> square(300), sawtooth(300);
+    for (int day = 0; day < 300; day++) {
+        square[day] = (day / 13) % 2 == 0 ? 100.3 : 99.9;
+        sawtooth[day] = 99.9 + 0.1 * (day % 7);
+    }
+    for (const vector<double> *wave : {&square, &sawtooth}) {
+        Market waveMarket(0, 0, 0, 0, -1);
+        waveMarket.assignPrices(PriceView(wave->data(), static_cast<int>(wave->size())));
+        TradingBot bot(&waveMarket);
+        for (int s = 1; s <= 12; s++) {
+            for (int l = s + 1; l <= 40; l += 3) {
+                bot.addStrategy(new TrendFollowingStrategy("TF", s, l));
+                bot.addStrategy(new WeightedTrendFollowingStrategy("WTF", s, l));
+            }
+            for (int t = 0; t <= 2; t++) {
+                bot.addStrategy(new MeanReversionStrategy("MR", s, t));
+            }
+        }
+        LiveSession session(bot);
+        session.setLatencyTracking(false);
+        IndicatorEngine indicators(&waveMarket, 0, 300);
+        for (int day = 0; day < 300; day++) {
+            session.onTick(waveMarket.getPrice(day));
+        }
+        for (int slot = 0; slot < session.getStrategyCount(); slot++) {
+            StrategyStats expected = session.getStrategy(slot)->backtest(indicators, 0, 300);
+            StrategyStats actual = session.getStats(slot);
+            assert(actual.tradeCount == expected.tradeCount && actual.exposureDays == expected.exposureDays);
+            assert(actual.profit == expected.profit);
+        }
+    }
+    cout << "- Near-tied averages are settled the backtest's way on periodic prices\n";
+    
+    // Strategies without a live rule hold, and timing can be turned off
+    LiveSession quiet;
+    AlternatingStrategy alternating;
+    quiet.setLatencyTracking(false);
+    int slot = quiet.addStrategy(&alternating);
+    for (int day = 0; day < 10; day++) {
+        assert(quiet.onTick(100.0 + day)[slot] == HOLD);
+    }
+    assert(!quiet.isLive(slot) && quiet.getHolding(slot) == 0.0 && quiet.getLatency(slot).getCount() == 0);
+    cout << "- Strategies without a live rule only HOLD\n";
+}
+
+// Test the lock-free queue and the pipelined Monte Carlo run against a serial one
+void testMonteCarloPipeline() {
+    cout << "\n=== TESTING MONTE CARLO PIPELINE ===\n";
+    
+    SpscQueue<int> queue(3);
+    assert(queue.capacity() == 4 && queue.empty());
+    for (int i = 0; i < 4; i++) {
+        assert(queue.tryPush(i));
+    }
+    assert(!queue.tryPush(4));
+    int item;
+    assert(queue.tryPop(item) && item == 0 && queue.tryPush(4));
+    for (int i = 1; i <= 4; i++) {
+        assert(queue.tryPop(item) && item == i);
+    }
+    assert(!queue.tryPop(item));
+    
+    // One producer and one consumer thread: every item arrives once, in order
+    SpscQueue<int> handoff(8);
+    const int itemCount = 100000;
+    thread producer([&handoff]() {
+        for (int i = 0; i < itemCount; i++) {
+            while (!handoff.tryPush(i)) {
+                this_thread::yield();
+            }
+        }
+    });
+    for (int expected = 0; expected < itemCount; expected++) {
+        while (!handoff.tryPop(item)) {
+            this_thread::yield();
+        }
+        assert(item == expected);
+    }
+    producer.join();
+    cout << "- SPSC queue delivers " << itemCount << " items in order across threads\n";
+    
+    MarketEnsemble ensemble(100.0, 0.3, 0.1, 150, 300, 2024);
+    Market unused(0, 0, 0, 0, -1);
+    TradingBot bot(&unused);
+    bot.addStrategy(new TrendFollowingStrategy("TF", 5, 20));
+    bot.addStrategy(new WeightedTrendFollowingStrategy("WTF", 8, 30));
+    bot.addStrategy(new MeanReversionStrategy("MR", 10, 3));
+    bot.addStrategy(new AlternatingStrategy());
+    
+    PipelineOptions options;
+    options.pathsPerChunk = 16;
+    options.queueDepth = 2;
+    MonteCarloResult single = bot.runMonteCarlo(ensemble, options);
+    options.lanes = 3;
+    MonteCarloResult laned = bot.runMonteCarlo(ensemble, options);
+    assert(single.paths == 300 && laned.bufferedPathCapacity == 3 * 2 * 16);
+    assert(single.meanProfit == laned.meanProfit && single.wins == laned.wins && single.meanBestProfit == laned.meanBestProfit);
+    cout << "- Results are identical for 1 and 3 lanes, holding at most " << laned.bufferedPathCapacity << " of 300 paths\n";
+    
+    // Same numbers as generating every path first and then backtesting each one
+    ensemble.simulate();
+    vector<double> profitSum(bot.getStrategyCount(), 0.0);
+    vector<int> wins(bot.getStrategyCount(), 0);
+    for (int path = 0; path < ensemble.getNumPaths(); path++) {
+        Market market(0, 0, 0, 0, -1);
+        market.assignPrices(ensemble.getPath(path));
+        int startDay = max(market.getNumTradingDays() - (EVALUATION_WINDOW + 1), 0);
+        IndicatorEngine indicators(&market, startDay, market.getNumTradingDays());
+        int best = 0;
+        vector<double> profits;
+        for (int s = 0; s < bot.getStrategyCount(); s++) {
+            profits.push_back(bot.getStrategy(s)->backtest(indicators, startDay, market.getNumTradingDays()).profit);
+            profitSum[s] += profits[s];
+            best = profits[s] > profits[best] ? s : best;
+        }
+        wins[best]++;
+    }
+    assert(wins == single.wins);
+    for (int s = 0; s < bot.getStrategyCount(); s++) {
+        assert(areEqual(profitSum[s] / 300, single.meanProfit[s], 1e-9));
+    }
+    cout << "- Pipelined results match a generate-then-evaluate run\n";
+    
+    // Nothing to evaluate
+    MarketEnsemble empty(100.0, 0.3, 0.1, 150, 0, 1);
+    assert(bot.runMonteCarlo(empty).paths == 0);
+}
+
+void testMultiAssetMarket() {
+    cout << "\n=== TESTING MULTI-ASSET MARKET ===\n";
+    
+    // Uncorrelated assets draw exactly the MarketEnsemble paths of the same index
+    const int assets = 6;
+    vector<double> initial(assets, 100.0), returns(assets, 0.1);
+    MultiAssetMarket independent(initial, returns, MultiAssetMarket::uniformCovariance(assets, 0.3, 0.0), 300, 77);
+    independent.simulate();
+    MarketEnsemble ensemble(100.0, 0.3, 0.1, 300, assets, 77);
+    ensemble.simulate();
+    assert(independent.getNumAssets() == assets && independent.getNumTradingDays() == 300);
+    for (int asset = 0; asset < assets; asset++) {
+        for (int day = 0; day < 300; day++) {
+            assert(independent.getPrice(asset, day) == ensemble.getPrice(asset, day));
+        }
+    }
+    assert(independent.getAsset(assets).empty() && independent.getPrice(0, 300) == 0.0);
+    cout << "- Uncorrelated assets reproduce MarketEnsemble paths\n";
+    
+    // Mixed volatilities and correlations: L * L^T is the correlation matrix, and sample
+    // statistics of the log returns follow the covariance
+    vector<double> vols = {0.2, 0.35, 0.5};
+    double rho[3][3] = {{1.0, 0.6, -0.3}, {0.6, 1.0, 0.2}, {-0.3, 0.2, 1.0}};
+    vector<double> covariance(9);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            covariance[i * 3 + j] = vols[i] * vols[j] * rho[i][j];
+        }
+    }
+    const int longDays = 8000;
+    MultiAssetMarket book({1e6, 1e6, 1e6}, {0.05, 0.1, 0.0}, covariance, longDays, 5);
+    book.setExactRounding(false);
+    book.simulate();
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            double product = 0.0;
+            for (int k = 0; k < 3; k++) {
+                product += book.getCorrelationFactor(i, k) * book.getCorrelationFactor(j, k);
+            }
+            assert(areEqual(product, rho[i][j], 1e-12));
+        }
+    }
+    vector<vector<double>> logReturns(3, vector<double>(longDays - 1));
+    for (int i = 0; i < 3; i++) {
+        for (int day = 1; day < longDays; day++) {
+            logReturns[i][day - 1] = log(book.getPrice(i, day) / book.getPrice(i, day - 1));
+        }
+    }
+    auto sampleCovariance = [&](int a, int b) {
+        double meanA = 0.0, meanB = 0.0, sum = 0.0;
+        for (int d = 0; d < longDays - 1; d++) {
+            meanA += logReturns[a][d];
+            meanB += logReturns[b][d];
+        }
+        meanA /= longDays - 1;
+        meanB /= longDays - 1;
+        for (int d = 0; d < longDays - 1; d++) {
+            sum += (logReturns[a][d] - meanA) * (logReturns[b][d] - meanB);
+        }
+        return sum / (longDays - 2) * TRADING_DAYS_PER_YEAR;
+    };
+    for (int i = 0; i < 3; i++) {
+        assert(fabs(sqrt(sampleCovariance(i, i)) - vols[i]) < 0.02 * vols[i] + 0.005);
+        for (int j = 0; j < i; j++) {
+            double correlation = sampleCovariance(i, j) / sqrt(sampleCovariance(i, i) * sampleCovariance(j, j));
+            assert(fabs(correlation - rho[i][j]) < 0.03);
+        }
+    }
+    cout << "- Log returns follow the requested volatilities and correlations\n";
+    
+    // Perfectly correlated assets are allowed and move together; bad matrices are refused
+    MultiAssetMarket twins({50.0, 50.0}, {0.1, 0.1}, MultiAssetMarket::uniformCovariance(2, 0.4, 1.0), 200, 9);
+    twins.simulate();
+    assert(twins.getNumAssets() == 2 && twins.getCorrelationFactor(1, 1) == 0.0);
+    for (int day = 0; day < 200; day++) {
+        assert(twins.getPrice(0, day) == twins.getPrice(1, day));
+    }
+    MultiAssetMarket indefinite(vector<double>(3, 100.0), vector<double>(3, 0.1), MultiAssetMarket::uniformCovariance(3, 0.3, -0.9), 100, 1);
+    MultiAssetMarket mismatched(vector<double>(3, 100.0), vector<double>(2, 0.1), MultiAssetMarket::uniformCovariance(3, 0.3, 0.1), 100, 1);
+    assert(indefinite.getNumAssets() == 0 && mismatched.getNumAssets() == 0);
+    cout << "- Perfect correlation is supported and invalid covariances are rejected\n";
+    
+    // Prices and portfolio results do not depend on the thread count
+    const int bookSize = 24;
+    vector<double> bookPrices(bookSize), bookReturns(bookSize);
+    for (int asset = 0; asset < bookSize; asset++) {
+        bookPrices[asset] = 20.0 + 10.0 * asset;
+        bookReturns[asset] = -0.1 + 0.01 * asset;
+    }
+    vector<double> bookCovariance = MultiAssetMarket::uniformCovariance(bookSize, 0.3, 0.4);
+    MultiAssetMarket serial(bookPrices, bookReturns, bookCovariance, 400, 2024);
+    MultiAssetMarket threaded(bookPrices, bookReturns, bookCovariance, 400, 2024);
+    threaded.setThreadCount(3);
+    serial.simulate();
+    threaded.simulate();
+    assert(equal(serial.getAllPrices().begin(), serial.getAllPrices().end(), threaded.getAllPrices().begin()));
+    
+    Market unused(0, 0, 0, 0, -1);
+    PortfolioResult results[2];
+    for (int threads : {1, 3}) {
+        TradingBot bot(&unused);
+        bot.setThreadCount(threads);
+        bot.addStrategy(new TrendFollowingStrategy("TF", 5, 20));
+        bot.addStrategy(new WeightedTrendFollowingStrategy("WTF", 8, 30));
+        for (int threshold = 1; threshold <= 6; threshold++) {
+            bot.addStrategy(new MeanReversionStrategy("MR", 10, threshold));
+        }
+        bot.addStrategy(new AlternatingStrategy());
+        results[threads == 1 ? 0 : 1] = bot.runPortfolio(serial);
+        
+        // Every cell is the strategy's own backtest on that asset
+        PortfolioResult &result = results[threads == 1 ? 0 : 1];
+        assert(result.assets == bookSize && result.strategies == bot.getStrategyCount());
+        int startDay = 400 - (EVALUATION_WINDOW + 1);
+        double total = 0.0;
+        for (int asset = 0; asset < bookSize; asset++) {
+            Market assetMarket(0, 0, 0, 0, -1);
+            assetMarket.assignPrices(serial.getAsset(asset));
+            IndicatorEngine indicators(&assetMarket, startDay, 400);
+            double assetSum = 0.0;
+            for (int i = 0; i < bot.getStrategyCount(); i++) {
+                double expected = bot.getStrategy(i)->backtest(indicators, startDay, 400).profit;
+                assert(result.getProfit(asset, i) == expected);
+                assetSum += expected;
+            }
+            assert(result.assetProfit[asset] == assetSum);
+            total += assetSum;
+        }
+        assert(result.totalProfit == total);
+    }
+    assert(results[0].profits == results[1].profits && results[0].strategyProfit == results[1].strategyProfit);
+    assert(results[0].bestStrategy == results[1].bestStrategy && results[0].bestOverall == results[1].bestOverall);
+    assert(results[0].bestOverall >= 0);
+    cout << "- Portfolio runs match per-asset backtests for any thread count\n";
+}
+
+void testInstrumentation() {
+    cout << "\n=== TESTING INSTRUMENTATION ===\n";
+    
+    // Sites work directly whether or not the INSTRUMENT_* macros are compiled in
+    Instrumentation::reset();
+    static InstrumentSite *outer = Instrumentation::registerSite(new InstrumentSite("test outer"));
+    static InstrumentSite *inner = Instrumentation::registerSite(new InstrumentSite("test inner"));
+    Instrumentation::setTracing(true);
+    for (int i = 0; i < 3; i++) {
+        ScopedTimer outerScope(outer);
+        outerScope.addItems("days", 10);
+        outerScope.addItems("strategies", 2);
+        ScopedTimer innerScope(inner);
+    }
+    Instrumentation::setTracing(false);
+    assert(outer->calls == 3 && inner->calls == 3);
+    assert(outer->nanoseconds >= inner->nanoseconds);
+    assert(outer->counters[0] == 30 && outer->counters[1] == 6);
+    outer->addItems("third counter", 1); // no free slot: ignored
+    assert(outer->counters[0] == 30 && outer->counters[1] == 6);
+    
+    ostringstream summary;
+    Instrumentation::printSummary(summary);
+    assert(summary.str().find("| test outer | 3 |") != string::npos);
+    assert(summary.str().find("30 days") != string::npos && summary.str().find("6 strategies") != string::npos);
+    cout << "- Scoped timers count calls, time and items per site\n";
+    
+    // Six complete events, and none recorded once tracing is off
+    {
+        ScopedTimer untraced(inner);
+    }
+    assert(Instrumentation::writeTrace("data/test_trace.json"));
+    ifstream trace("data/test_trace.json");
+    string json((istreambuf_iterator<char>(trace)), istreambuf_iterator<char>());
+    size_t events = 0;
+    for (size_t at = json.find("\"ph\":\"X\""); at != string::npos; at = json.find("\"ph\":\"X\"", at + 1)) {
+        events++;
+    }
+    assert(events == 6);
+    assert(json.find("\"traceEvents\":[") == 1 && json.find("\"name\":\"test inner\"") != string::npos);
+    remove("data/test_trace.json");
+    cout << "- Trace events are written as Chrome trace JSON\n";
+    
+    Instrumentation::reset();
+    assert(outer->calls == 0 && outer->counters[0] == 0);
+}
+
 // Test Strategy class functionality and edge cases
 void testStrategy() {
     cout << "\n=== TESTING STRATEGY CLASSES ===\n";
@@ -281,6 +1890,121 @@ void testStrategy() {
     }
 }
 
+// Test cached indicator tables against the per-call moving averages
+void testIndicatorEngine() {
+    cout << "\n=== TESTING INDICATOR ENGINE ===\n";
+    
+    Market market(100.0, 0.3, 0.2, 300, 42);
+    market.simulate();
+    MeanReversionStrategy reference("MR_Ref", 10, 5);
+    
+    // Cached averages must be bit-identical to Strategy::calculateMovingAverage
+    IndicatorEngine indicators(&market, 150, 300);
+    for (int window = 1; window <= 120; window++) {
+        indicators.requireSimpleAverage(window);
+        for (int index = 0; index < 310; index++) {
+            assert(indicators.simpleMovingAverage(index, window) == reference.calculateMovingAverage(&market, index, window));
+        }
+    }
+    assert(indicators.simpleMovingAverage(200, 0) == reference.calculateMovingAverage(&market, 200, 0));
+    assert(indicators.simpleMovingAverage(-3, 5) == reference.calculateMovingAverage(&market, -3, 5));
+    cout << "- Cached simple moving averages are bit-identical\n";
+    
+    // Both decideAction paths agree for every built-in strategy
+    TrendFollowingStrategy tfs("TF", 5, 20);
+    MeanReversionStrategy mrs("MR", 10, 2);
+    WeightedTrendFollowingStrategy wtfs("WTF", 5, 20);
+    const Strategy *strategies[] = {&tfs, &mrs, &wtfs};
+    for (const Strategy *strategy : strategies) {
+        strategy->registerIndicators(indicators);
+        for (int index = 150; index < 300; index++) {
+            for (double holding = 0.0; holding <= 1.0; holding += 1.0) {
+                assert(strategy->decideAction(indicators, index, holding) == strategy->decideAction(&market, index, holding));
+            }
+        }
+    }
+    cout << "- Indicator-based decideAction matches the market-based path\n";
+}
+
+// Original O(window^2) weighted average, recomputing each weight from scratch
+double legacyWeightedAverage(Market &market, int index, int window) {
+    int startIdx = max(index - window + 1, 0);
+    double weightedSum = 0.0, totalWeight = 0.0;
+    for (int i = startIdx; i <= index; i++) {
+        double weight = 1.0;
+        for (int k = 0; k < i - startIdx; k++) {
+            weight *= 1.1;
+        }
+        weightedSum += market.getPrice(i) * weight;
+        totalWeight += weight;
+    }
+    return weightedSum / totalWeight;
+}
+
+// Test the rolling weighted average against the original implementation
+void testWeightedMovingAverage() {
+    cout << "\n=== TESTING ROLLING WEIGHTED AVERAGE ===\n";
+    
+    Market market(100.0, 0.4, 0.1, 3000, 42);
+    market.simulate();
+    WeightedTrendFollowingStrategy wtfs("WTF_Ref", 5, 20);
+    
+    // Per-call path is unchanged bit for bit
+    for (int window = 1; window <= 60; window += 7) {
+        for (int index = 0; index < 200; index += 3) {
+            assert(wtfs.calculateMovingAverage(&market, index, window) == legacyWeightedAverage(market, index, window));
+        }
+    }
+    cout << "- Per-call weighted average matches the original formula\n";
+    
+    // Rolling tables stay within tolerance, including across refreshes on a long series
+    IndicatorEngine indicators(&market, 0, market.getNumTradingDays());
+    int windows[] = {1, 2, 5, 20, 63, 64, 65, 150, 400};
+    for (int window : windows) {
+        for (int index = 0; index < market.getNumTradingDays(); index++) {
+            assert(areEqual(indicators.weightedMovingAverage(index, window), wtfs.calculateMovingAverage(&market, index, window)));
+        }
+    }
+    cout << "- Rolling weighted average matches the per-call path within tolerance\n";
+    
+    // Queries outside the cached range fall back to a direct computation
+    IndicatorEngine partial(&market, 1000, 1100);
+    assert(partial.weightedMovingAverage(500, 30) == wtfs.calculateMovingAverage(&market, 500, 30));
+    assert(partial.weightedMovingAverage(1050, 0) == market.getPrice(1050));
+    cout << "- Out-of-range weighted lookups fall back correctly\n";
+    
+    // Square and sawtooth waves put many pairs of averages within rounding of each other;
+    // every strategy must still trade exactly like the per-call formula
+    vector<double> square(300), sawtooth(300);
+    for (int day = 0; day < 300; day++) {
+        square[day] = (day / 13) % 2 == 0 ? 100.3 : 99.9;
+        sawtooth[day] = 99.9 + 0.1 * (day % 7);
+    }
+    for (const vector<double> *wave : {&square, &sawtooth}) {
+        Market waveMarket(0, 0, 0, 0, -1);
+        waveMarket.assignPrices(PriceView(wave->data(), static_cast<int>(wave->size())));
+        int startDay = 300 - (EVALUATION_WINDOW + 1);
+        for (EvaluationMode mode : {PER_STRATEGY, FUSED}) {
+            TradingBot bot(&waveMarket);
+            bot.setEvaluationMode(mode);
+            vector<WeightedTrendFollowingStrategy> references;
+            for (int s = 1; s <= 12; s++) {
+                for (int l = s + 1; l <= 40; l += 3) {
+                    bot.addStrategy(new WeightedTrendFollowingStrategy("WTF", s, l));
+                    references.push_back(WeightedTrendFollowingStrategy("WTF", s, l));
+                }
+            }
+            Leaderboard board;
+            bot.runSimulation(board);
+            assert(board.size() == static_cast<int>(references.size()));
+            for (int row = 0; row < board.size(); row++) {
+                assert(board.getProfit(row) == marketLoopProfit(references[board.getId(row)], waveMarket, startDay));
+            }
+        }
+    }
+    cout << "- Near-tied weighted averages trade like the per-call formula\n";
+}
+
 // Test TradingBot functionality and edge cases
 void testTradingBot() {
     cout << "\n=== TESTING TRADING BOT ===\n";
@@ -326,6 +2050,137 @@ void testTradingBot() {
     delete market;
 }
 
+// Test the work-stealing pool and parallel simulation against the serial run
+void testParallelSimulation() {
+    cout << "\n=== TESTING PARALLEL SIMULATION ===\n";
+    
+    // Every index runs exactly once, however uneven the work
+    WorkStealingPool pool(4);
+    vector<int> visits(1000, 0);
+    pool.parallelFor(1000, [&](int i) {
+        volatile double spin = 0.0;
+        for (int k = 0; k < (i % 17) * 200; k++) {
+            spin = spin + k;
+        }
+        visits[i]++;
+    });
+    for (int count : visits) {
+        assert(count == 1);
+    }
+    cout << "- WorkStealingPool visits every index once\n";
+    
+    // Task exceptions surface in the caller
+    bool caught = false;
+    try {
+        pool.parallelFor(100, [](int i) {
+            if (i == 42) {
+                throw runtime_error("task failed");
+            }
+        });
+    } catch (const runtime_error &) {
+        caught = true;
+    }
+    assert(caught);
+    cout << "- WorkStealingPool rethrows task exceptions\n";
+    
+    // Parallel runs pick the same winner and return as the serial run, ties included
+    Market* market = new Market(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+    market->loadFromFile("bullish_high_vol.txt");
+    string serialBest;
+    double serialReturn = 0.0;
+    for (int threads : {1, 2, 3, 8}) {
+        TradingBot bot(market);
+        bot.setThreadCount(threads);
+        for (int copy = 0; copy < 2; copy++) {
+            for (int s = 5; s <= 15; s += 5) {
+                for (int l = 20; l <= 60; l += 10) {
+                    bot.addStrategy(new WeightedTrendFollowingStrategy("WTF_" + to_string(copy) + "_" + to_string(s) + "_" + to_string(l), s, l));
+                    bot.addStrategy(new TrendFollowingStrategy("TF_" + to_string(copy) + "_" + to_string(s) + "_" + to_string(l), s, l));
+                }
+                for (int t = 1; t <= 5; t++) {
+                    bot.addStrategy(new MeanReversionStrategy("MR_" + to_string(copy) + "_" + to_string(s) + "_" + to_string(t), s, t));
+                }
+            }
+        }
+        SimulationResult result = bot.runSimulation();
+        if (threads == 1) {
+            serialBest = result.bestStrategy->getName();
+            serialReturn = result.totalReturn;
+            assert(serialBest.find("_0_") != string::npos);
+        } else {
+            assert(result.bestStrategy->getName() == serialBest);
+            assert(result.totalReturn == serialReturn);
+        }
+    }
+    delete market;
+    cout << "- Parallel runSimulation matches the serial result exactly\n";
+}
+
+// Test full and bounded leaderboards produced by runSimulation
+void testLeaderboard() {
+    cout << "\n=== TESTING LEADERBOARD ===\n";
+    
+    // Bounded mode keeps exactly the best K rows regardless of arrival order, ties by id
+    Leaderboard all;
+    Leaderboard top(4);
+    int order[] = {7, 3, 9, 0, 5, 1, 8, 2, 6, 4};
+    for (int id : order) {
+        StrategyStats stats;
+        stats.profit = (id % 5) * 1.5;
+        all.record(id, stats);
+        top.record(id, stats);
+    }
+    all.sortByRank();
+    top.sortByRank();
+    assert(all.size() == 10 && top.size() == 4 && top.getCandidatesSeen() == 10);
+    for (int row = 0; row < top.size(); row++) {
+        assert(top.getId(row) == all.getId(row));
+    }
+    assert(top.getId(0) == 4 && top.getId(1) == 9 && top.getId(2) == 3 && top.getId(3) == 8);
+    cout << "- Bounded leaderboard keeps the top K with deterministic ties\n";
+    
+    // runSimulation fills one row per strategy, and its best row is the SimulationResult
+    Market* market = new Market(0, 0, 0, TRADING_DAYS_PER_YEAR, 999);
+    market->loadFromFile("bullish_low_vol.txt");
+    TradingBot bot(market);
+    TrendFollowingStrategy** trendStrategies = TrendFollowingStrategy::generateStrategySet("Trend", 5, 15, 5, 20, 100, 10);
+    for (int i = 0; i < 27; ++i) {
+        bot.addStrategy(trendStrategies[i]);
+    }
+    delete[] trendStrategies;
+    MeanReversionStrategy** meanReversionStrategies = MeanReversionStrategy::generateStrategySet("MeanReversion", 5, 15, 5, 1, 5, 1);
+    for (int i = 0; i < 15; ++i) {
+        bot.addStrategy(meanReversionStrategies[i]);
+    }
+    delete[] meanReversionStrategies;
+    
+    Leaderboard board;
+    Leaderboard best(5);
+    SimulationResult result = bot.runSimulation(board);
+    bot.runSimulation(best);
+    board.sortByRank();
+    best.sortByRank();
+    assert(board.size() == 42);
+    assert(bot.getStrategy(static_cast<int>(board.getId(0))) == result.bestStrategy);
+    assert(board.getProfit(0) == result.totalReturn);
+    for (int row = 0; row < board.size(); row++) {
+        if (row > 0) {
+            assert(board.getProfit(row) <= board.getProfit(row - 1));
+        }
+        if (row < best.size()) {
+            assert(best.getId(row) == board.getId(row));
+        }
+        assert(board.getWinRate(row) >= 0.0 && board.getWinRate(row) <= 1.0);
+        assert(board.getMaxDrawdown(row) >= 0.0);
+        assert(board.getExposureDays(row) >= 0 && board.getExposureDays(row) <= 101);
+        assert(board.getTradeCount(row) > 0 || board.getProfit(row) == 0.0);
+    }
+    cout << "- runSimulation leaderboard is ranked and consistent with the best result\n";
+    cout << "  Top strategy: " << result.bestStrategy->getName() << " (" << board.getTradeCount(0) << " trades, "
+         << board.getWinRate(0) * 100 << "% wins, max drawdown " << board.getMaxDrawdown(0) << ")\n";
+    delete market;
+}
+
 // Test performance and timing
 void testPerformance() {
     cout << "\n=== TESTING PERFORMANCE ===\n";
@@ -695,8 +2550,32 @@ int main() {
         testMemoryManagement();
         testAutomaticMemoryManagement();
         testMarket();
+        testPriceSeries();
+        testBinaryMarket();
+        testMarketTextParser();
+        testMarketEnsemble();
+        testGbmKernel();
         testStrategy();
+        testIndicatorEngine();
+        testWeightedMovingAverage();
         testTradingBot();
+        testParallelSimulation();
+        testFusedBacktest();
+        testStrategyKernels();
+        testDecideActions();
+        testStrategySubclasses();
+        testParameterSweep();
+        testOptimizer();
+        testWalkForward();
+        testSimpleAverageTable();
+        testMeanReversionBatch();
+        testSignalHistory();
+        testStrategyArena();
+        testLiveSession();
+        testMonteCarloPipeline();
+        testMultiAssetMarket();
+        testInstrumentation();
+        testLeaderboard();
         testPerformance();
         testUndefinedBehavior();
         // testUseAfterFree();